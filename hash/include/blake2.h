@@ -298,7 +298,7 @@ namespace Blake2_NS
 			Uint128 m_sizeCounter;
 
 			uint64_t m_h[8] = {};
-			const uint64_t m_initializationVector[8] =
+			static constexpr uint64_t m_initializationVector[8] =
 			{
 				0x6a09e667f3bcc908, 0xbb67ae8584caa73b, 0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
 				0x510e527fade682d1, 0x9b05688c2b3e6c1f, 0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
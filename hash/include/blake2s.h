@@ -235,7 +235,7 @@ namespace Blake2s_NS
 			uint64_t m_sizeCounter = 0;
 
 			uint32_t m_h[8] = {};
-			const uint32_t m_initializationVector[8] =
+			static constexpr uint32_t m_initializationVector[8] =
 			{
 				0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
 				0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
@@ -91,7 +91,8 @@ namespace CShake_NS
 			constexpr CShake& operator=(CShake &&other) noexcept;
 
 			constexpr void reset();
-			constexpr CShake& finalize();  // after this, only `operator T()`, `reset()`, `toString()`, `toVector()` are available
+			constexpr CShake& finalize();  // after this, only `operator T()`, `reset()`, `squeeze()`, `toString()`, `toVector()` are available
+			void squeeze(void *ptr, const std::size_t length);  // extendable output following the digest
 
 			std::string toString() const;
 			std::vector<Byte> toVector() const;
@@ -242,6 +243,15 @@ namespace CShake_NS
 		return (*this);
 	}
 
+	template <typename S, typename K, int P>
+	void CShake<S, K, P>::squeeze(void *ptr, const std::size_t length)
+	{
+		if (!m_customized)
+			m_shake->squeeze(ptr, length);
+		else
+			m_keccak->squeeze(ptr, length);
+	}
+
 	template <typename S, typename K, int P>
 	std::string CShake<S, K, P>::toString() const
 	{
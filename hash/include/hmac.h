@@ -0,0 +1,271 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_HMAC_H
+#define CHOCOBO1_HMAC_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// HMAC<Hash, BlockSizeInBytes>(const std::string &key);
+	// e.g. HMAC<SHA2_256, 64>, HMAC<SHA2_512, 128>, HMAC<SHA3_256, (1088 / 8)>
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+namespace HMAC_NS
+{
+	template <typename H, int B>  // `H`: Merkle-Damgard or sponge hash, `B`: its input block size in bytes
+	class HMAC
+	{
+		// https://doi.org/10.6028/NIST.FIPS.198-1
+		// https://tools.ietf.org/html/rfc2104
+
+		public:
+			using Byte = uint8_t;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			explicit HMAC(const std::string &key);
+
+			void reset();  // back to the state right after K0 ^ ipad was absorbed
+			static constexpr std::size_t MAX_DIGEST_SIZE = B;  // digests of the underlying hashes never exceed their block
+
+			HMAC& finalize();  // after this, only `operator T()`, `reset()`, `toSpan()`, `toString()`, `toVector()` are available
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			Span<const Byte> toSpan() const;  // view of the digest, valid until the next `finalize()`
+			template <typename T>
+			operator T() const noexcept;
+
+			HMAC& addData(const Span<const Byte> inData);
+			HMAC& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			HMAC& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			HMAC& addData(const T (&array)[N]);
+			template <typename T>
+			HMAC& addData(const Span<T> inSpan);
+
+		private:
+			template <typename T, typename = void>
+			struct HasToArray : std::false_type {};
+			template <typename T>
+			struct HasToArray<T, std::void_t<decltype(std::declval<const T&>().toArray())>> : std::true_type {};
+
+			static std::size_t copyDigest(const H &hash, Byte *out);  // toArray() or the sponge's toSpan(), no heap
+
+			// midstates after the compressed K0 ^ ipad and K0 ^ opad blocks, computed once per key
+			H m_innerKeyed;
+			H m_outerKeyed;
+
+			H m_inner;
+			H m_outer;
+
+			Byte m_digest[B] = {};
+			std::size_t m_digestSize = 0;
+	};
+
+
+	//
+	template <typename H, int B>
+	HMAC<H, B>::HMAC(const std::string &key)
+	{
+		static_assert((B > 0), "Template parameter value invalid: B");
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+
+		Byte k0[B] = {};
+		if (key.size() > B)
+		{
+			const std::vector<Byte> digest = H().addData(key.data(), key.size()).finalize().toVector();
+			std::copy_n(digest.begin(), std::min<std::size_t>(digest.size(), B), k0);
+		}
+		else
+		{
+			std::copy(key.begin(), key.end(), k0);
+		}
+
+		Byte pad[B];
+		for (int i = 0; i < B; ++i)
+			pad[i] = (k0[i] ^ 0x36);
+		m_innerKeyed.addData(pad);
+		for (int i = 0; i < B; ++i)
+			pad[i] = (k0[i] ^ 0x5C);
+		m_outerKeyed.addData(pad);
+
+		reset();
+	}
+
+	template <typename H, int B>
+	void HMAC<H, B>::reset()
+	{
+		m_inner = m_innerKeyed;
+	}
+
+	template <typename H, int B>
+	HMAC<H, B>& HMAC<H, B>::finalize()
+	{
+		m_inner.finalize();
+		const std::size_t innerSize = copyDigest(m_inner, m_digest);
+
+		m_outer = m_outerKeyed;
+		m_outer.addData(m_digest, innerSize);
+		m_outer.finalize();
+		m_digestSize = copyDigest(m_outer, m_digest);
+		return (*this);
+	}
+
+	template <typename H, int B>
+	std::string HMAC<H, B>::toString() const
+	{
+		return m_outer.toString();
+	}
+
+	template <typename H, int B>
+	std::vector<typename HMAC<H, B>::Byte> HMAC<H, B>::toVector() const
+	{
+		return m_outer.toVector();
+	}
+
+	template <typename H, int B>
+	typename HMAC<H, B>::template Span<const typename HMAC<H, B>::Byte> HMAC<H, B>::toSpan() const
+	{
+		return {m_digest, m_digestSize};
+	}
+
+	template <typename H, int B>
+	std::size_t HMAC<H, B>::copyDigest(const H &hash, Byte *out)
+	{
+		if constexpr (HasToArray<H>::value)
+		{
+			const auto digest = hash.toArray();
+			static_assert((std::tuple_size<decltype(digest)>::value <= B), "Digest longer than the block");
+			std::copy(digest.begin(), digest.end(), out);
+			return digest.size();
+		}
+		else
+		{
+			const auto digest = hash.toSpan();
+			const std::size_t size = std::min<std::size_t>(digest.size(), B);
+			std::copy_n(digest.begin(), size, out);
+			return size;
+		}
+	}
+
+	template <typename H, int B>
+	template <typename T>
+	HMAC<H, B>::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		const auto digest = toVector();
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), digest.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= digest[i];
+		}
+		return ret;
+	}
+
+	template <typename H, int B>
+	HMAC<H, B>& HMAC<H, B>::addData(const Span<const Byte> inData)
+	{
+		m_inner.addData(inData);
+		return (*this);
+	}
+
+	template <typename H, int B>
+	HMAC<H, B>& HMAC<H, B>::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <typename H, int B>
+	template <std::size_t N>
+	HMAC<H, B>& HMAC<H, B>::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <typename H, int B>
+	template <typename T, std::size_t N>
+	HMAC<H, B>& HMAC<H, B>::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <typename H, int B>
+	template <typename T>
+	HMAC<H, B>& HMAC<H, B>::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+}
+}
+
+	template <typename H, int B>
+	using HMAC = Hash::HMAC_NS::HMAC<H, B>;
+}
+
+namespace std
+{
+	template <typename H, int B>
+	struct hash<Chocobo1::Hash::HMAC_NS::HMAC<H, B>>
+	{
+		size_t operator()(const Chocobo1::Hash::HMAC_NS::HMAC<H, B> &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_HMAC_H
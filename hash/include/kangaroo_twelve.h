@@ -0,0 +1,520 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_KANGAROO_TWELVE_H
+#define CHOCOBO1_KANGAROO_TWELVE_H
+
+#include "sha3.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// TurboSHAKE_128(const int digestLengthInBytes);
+	// TurboSHAKE_256(const int digestLengthInBytes);
+
+	// KangarooTwelve(const int digestLengthInBytes, const std::string &customize = {});
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+#ifndef CHOCOBO1_HASH_ROR_IMPL
+#define CHOCOBO1_HASH_ROR_IMPL
+	template <typename R, typename T>
+	constexpr R ror(const T x, const unsigned int s)
+	{
+		static_assert(std::is_unsigned<R>::value, "");
+		static_assert(std::is_unsigned<T>::value, "");
+		return static_cast<R>(x >> s);
+	}
+#endif
+
+
+namespace K12_NS
+{
+	template <int R, int CV>  // `R`: TurboSHAKE rate. `CV`: chaining value size
+	class KangarooTwelve
+	{
+		// https://www.rfc-editor.org/rfc/rfc9861
+
+		public:
+			using Byte = uint8_t;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			explicit KangarooTwelve(const int digestLength, const std::string &customize = {});
+
+			void reset();
+			KangarooTwelve& finalize();  // after this, only `operator T()`, `reset()`, `squeeze()`, `toString()`, `toVector()` are available
+			void squeeze(void *ptr, const std::size_t length);  // extendable output following the digest
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			Span<const Byte> toSpan() const;  // view of the digest, valid until `reset()`
+			template <typename T>
+			operator T() const noexcept;
+
+			KangarooTwelve& addData(const Span<const Byte> inData);
+			KangarooTwelve& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			KangarooTwelve& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			KangarooTwelve& addData(const T (&array)[N]);
+			template <typename T>
+			KangarooTwelve& addData(const Span<T> inSpan);
+
+			void setMaxThreads(const unsigned int threads);  // 1, the default, disables parallel leaf hashing
+
+		private:
+			using SingleNode = SHA3_NS::Keccak<R, 0x07, 12>;
+			using FinalNode = SHA3_NS::Keccak<R, 0x06, 12>;
+			using LeafNode = SHA3_NS::Keccak<R, 0x0B, 12>;
+
+			static constexpr std::size_t CHUNK_SIZE = 8192;
+			static constexpr std::size_t PARALLEL_CHUNKS = 16;  // least number of whole chunks worth a thread pool
+			static constexpr std::size_t BATCH_CHUNKS = 128;  // chunks collected from short inputs before they are hashed
+
+			void addDataImpl(const Span<const Byte> data);
+			void addChainingValue(const std::vector<Byte> &cv);
+			void addChunks(const Span<const Byte> data);
+			void flushBatch();
+
+			static std::vector<Byte> leafChainingValue(const Span<const Byte> chunk);
+
+			int m_digestLength = 0;
+			std::string m_customize;
+			unsigned int m_maxThreads = 1;
+
+			std::vector<Byte> m_first;  // S_0, kept until the input is known to exceed one chunk
+			std::vector<Byte> m_final;
+			std::vector<Byte> m_batch;  // with threads allowed, whole chunks are collected here so that short segments still hash in parallel
+
+			SingleNode m_single;
+			FinalNode m_node;
+			LeafNode m_leaf;
+			std::size_t m_leafSize = 0;
+			uint64_t m_leafCount = 0;
+			bool m_tree = false;
+	};
+
+
+	// helpers
+	const auto lengthEncode = [](const uint64_t value) -> Buffer<uint8_t, (sizeof(value) + 1)>
+	{
+		uint8_t n = 0;
+		for (uint64_t v = value; v > 0; v >>= 8)
+			++n;
+
+		Buffer<uint8_t, (sizeof(value) + 1)> ret;
+		for (int i = (n - 1); i >= 0; --i)
+			ret.fill(ror<uint8_t>(value, (8 * i)));
+		ret.fill(n);
+
+		return ret;
+	};
+
+
+	//
+	template <int R, int CV>
+	KangarooTwelve<R, CV>::KangarooTwelve(const int digestLength, const std::string &customize)
+		: m_digestLength(digestLength)
+		, m_customize(customize)
+		, m_single(digestLength)
+		, m_node(digestLength)
+		, m_leaf(CV)
+	{
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+
+		m_first.reserve(CHUNK_SIZE);
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::reset()
+	{
+		m_first.clear();
+		m_final.clear();
+		m_batch.clear();
+
+		m_single.reset();
+		m_node.reset();
+		m_leaf.reset();
+		m_leafSize = 0;
+		m_leafCount = 0;
+		m_tree = false;
+	}
+
+	template <int R, int CV>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::finalize()
+	{
+		// S = M || C || length_encode(|C|)
+		addDataImpl({reinterpret_cast<const Byte*>(m_customize.data()), m_customize.size()});
+		const auto encodedC = lengthEncode(m_customize.size());
+		addDataImpl({encodedC.data(), encodedC.size()});
+
+		if (!m_tree)
+		{
+			m_single.addData(m_first.data(), m_first.size());
+			const auto digest = m_single.finalize().toSpan();
+			m_final.assign(digest.begin(), digest.end());
+			return (*this);
+		}
+
+		if (!m_batch.empty())
+			flushBatch();
+		if (m_leafSize > 0)
+			addChainingValue(m_leaf.finalize().toVector());
+
+		const auto encodedN = lengthEncode(m_leafCount);
+		m_node.addData({encodedN.data(), encodedN.size()});
+		const Byte terminator[2] = {0xFF, 0xFF};
+		m_node.addData(terminator);
+
+		const auto digest = m_node.finalize().toSpan();
+		m_final.assign(digest.begin(), digest.end());
+		return (*this);
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::squeeze(void *ptr, const std::size_t length)
+	{
+		if (!m_tree)
+			m_single.squeeze(ptr, length);
+		else
+			m_node.squeeze(ptr, length);
+	}
+
+	template <int R, int CV>
+	std::string KangarooTwelve<R, CV>::toString() const
+	{
+		const auto v = toVector();
+		std::string ret;
+		ret.resize(2 * v.size());
+
+		auto retPtr = &ret.front();
+		for (const auto c : v)
+		{
+			const Byte upper = ror<Byte>(c, 4);
+			*(retPtr++) = static_cast<char>((upper < 10) ? (upper + '0') : (upper - 10 + 'a'));
+
+			const Byte lower = c & 0xf;
+			*(retPtr++) = static_cast<char>((lower < 10) ? (lower + '0') : (lower - 10 + 'a'));
+		}
+
+		return ret;
+	}
+
+	template <int R, int CV>
+	std::vector<typename KangarooTwelve<R, CV>::Byte> KangarooTwelve<R, CV>::toVector() const
+	{
+		return m_final;
+	}
+
+	template <int R, int CV>
+	typename KangarooTwelve<R, CV>::template Span<const typename KangarooTwelve<R, CV>::Byte> KangarooTwelve<R, CV>::toSpan() const
+	{
+		return {m_final.data(), m_final.size()};
+	}
+
+	template <int R, int CV>
+	template <typename T>
+	KangarooTwelve<R, CV>::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		const auto digest = toVector();
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), digest.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= digest[i];
+		}
+		return ret;
+	}
+
+	template <int R, int CV>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::addData(const Span<const Byte> inData)
+	{
+		addDataImpl(inData);
+		return (*this);
+	}
+
+	template <int R, int CV>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <int R, int CV>
+	template <std::size_t N>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <int R, int CV>
+	template <typename T, std::size_t N>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <int R, int CV>
+	template <typename T>
+	KangarooTwelve<R, CV>& KangarooTwelve<R, CV>::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::setMaxThreads(const unsigned int threads)
+	{
+		m_maxThreads = std::max(1u, threads);
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::addDataImpl(const Span<const Byte> inData)
+	{
+		Span<const Byte> data = inData;
+
+		if (!m_tree)
+		{
+			const size_t len = std::min<size_t>((CHUNK_SIZE - m_first.size()), data.size());
+			m_first.insert(m_first.end(), data.begin(), (data.begin() + len));
+			data = data.subspan(len);
+
+			if (data.empty())  // S_0 may still be the whole message
+				return;
+
+			// more than one chunk: S_0 || 110^62 opens the final node
+			m_node.addData(m_first.data(), m_first.size());
+			const Byte marker[8] = {0x03, 0, 0, 0, 0, 0, 0, 0};
+			m_node.addData(marker);
+			m_first.clear();
+			m_tree = true;
+		}
+
+		if ((m_maxThreads < 2) && !m_batch.empty())  // the threads were taken back
+			flushBatch();
+
+		if (m_leafSize > 0)
+		{
+			const size_t len = std::min<size_t>((CHUNK_SIZE - m_leafSize), data.size());
+			m_leaf.addData(data.first(len));
+			m_leafSize += len;
+			data = data.subspan(len);
+
+			if (m_leafSize < CHUNK_SIZE)
+				return;
+
+			addChainingValue(m_leaf.finalize().toVector());
+			m_leaf.reset();
+			m_leafSize = 0;
+		}
+
+		if (m_maxThreads < 2)
+		{
+			const size_t len = data.size() - (data.size() % CHUNK_SIZE);
+			addChunks(data.first(len));
+			data = data.subspan(len);
+
+			if (!data.empty())
+			{
+				m_leaf.addData(data);
+				m_leafSize = data.size();
+			}
+			return;
+		}
+
+		// the batch starts on a chunk boundary, the leaf is never open while it holds data
+		constexpr size_t batchSize = BATCH_CHUNKS * CHUNK_SIZE;
+		while (!data.empty())
+		{
+			if (m_batch.empty() && (data.size() >= batchSize))  // large input is hashed in place
+			{
+				const size_t len = data.size() - (data.size() % CHUNK_SIZE);
+				addChunks(data.first(len));
+				data = data.subspan(len);
+				continue;
+			}
+
+			const size_t len = std::min<size_t>((batchSize - m_batch.size()), data.size());
+			m_batch.insert(m_batch.end(), data.begin(), (data.begin() + len));
+			data = data.subspan(len);
+
+			if (m_batch.size() == batchSize)
+			{
+				addChunks({m_batch.data(), m_batch.size()});
+				m_batch.clear();
+			}
+		}
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::flushBatch()
+	{
+		// whole chunks as leaves, the rest opens the leaf as unbatched input would
+		const size_t len = m_batch.size() - (m_batch.size() % CHUNK_SIZE);
+		addChunks({m_batch.data(), len});
+		m_leaf.addData({(m_batch.data() + len), (m_batch.size() - len)});
+		m_leafSize = m_batch.size() - len;
+		m_batch.clear();
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::addChainingValue(const std::vector<Byte> &cv)
+	{
+		m_node.addData(cv.data(), cv.size());
+		++m_leafCount;
+	}
+
+	template <int R, int CV>
+	void KangarooTwelve<R, CV>::addChunks(const Span<const Byte> data)
+	{
+		const size_t chunks = data.size() / CHUNK_SIZE;
+		const size_t threads = std::min<size_t>(m_maxThreads, (chunks / (PARALLEL_CHUNKS / 2)));
+
+		if ((chunks < PARALLEL_CHUNKS) || (threads < 2))
+		{
+			for (size_t i = 0; i < chunks; ++i)
+				addChainingValue(leafChainingValue(data.subspan((i * CHUNK_SIZE), CHUNK_SIZE)));
+			return;
+		}
+
+		// leaves are independent: hash them on worker threads, absorb the CVs in order
+		std::vector<std::vector<Byte>> cvs(chunks);
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+
+		const size_t share = (chunks + threads - 1) / threads;
+		for (size_t t = 0; t < threads; ++t)
+		{
+			const size_t first = t * share;
+			const size_t last = std::min(chunks, (first + share));
+			if (first >= last)
+				break;
+
+			workers.emplace_back([&cvs, data, first, last]()
+			{
+				for (size_t i = first; i < last; ++i)
+					cvs[i] = leafChainingValue(data.subspan((i * CHUNK_SIZE), CHUNK_SIZE));
+			});
+		}
+		for (auto &worker : workers)
+			worker.join();
+
+		for (const auto &cv : cvs)
+			addChainingValue(cv);
+	}
+
+	template <int R, int CV>
+	std::vector<typename KangarooTwelve<R, CV>::Byte> KangarooTwelve<R, CV>::leafChainingValue(const Span<const Byte> chunk)
+	{
+		LeafNode leaf(CV);
+		leaf.addData(chunk);
+		return leaf.finalize().toVector();
+	}
+}
+}
+
+	using TurboSHAKE_128 = SHAKEAlias<Hash::SHA3_NS::Keccak<(1344 / 8), 0x1F, 12>>;
+	using TurboSHAKE_256 = SHAKEAlias<Hash::SHA3_NS::Keccak<(1088 / 8), 0x1F, 12>>;
+
+	template <typename Base>
+	struct KangarooTwelveAlias : Base
+	{
+		using BaseType = Base;
+		explicit KangarooTwelveAlias(const int l, const std::string &c = {}) : Base(l, c) {}
+		KangarooTwelveAlias(const Base &other) : Base(other) {}
+		KangarooTwelveAlias(Base &&other) noexcept : Base(std::move(other)) {}
+		KangarooTwelveAlias& operator=(const Base &other) { if (this != &other) { Base::operator=(other); } return *this; }
+		KangarooTwelveAlias& operator=(Base &&other) noexcept { if (this != &other) { Base::operator=(std::move(other)); } return *this; }
+	};
+	using KangarooTwelve = KangarooTwelveAlias<Hash::K12_NS::KangarooTwelve<(1344 / 8), 32>>;
+}
+
+namespace std
+{
+	template <int R, int CV>
+	struct hash<Chocobo1::Hash::K12_NS::KangarooTwelve<R, CV>>
+	{
+		size_t operator()(const Chocobo1::Hash::K12_NS::KangarooTwelve<R, CV> &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::TurboSHAKE_128>
+	{
+		size_t operator()(const Chocobo1::TurboSHAKE_128 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::TurboSHAKE_256>
+	{
+		size_t operator()(const Chocobo1::TurboSHAKE_256 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::KangarooTwelve>
+	{
+		size_t operator()(const Chocobo1::KangarooTwelve &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_KANGAROO_TWELVE_H
@@ -0,0 +1,163 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_KDF_H
+#define CHOCOBO1_KDF_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// PBKDF2<Mac>(const std::string &password, const std::string &salt, const uint32_t iterations, const std::size_t length, const unsigned int maxThreads = 1);
+	// HKDF<Mac>(const std::string &ikm, const std::string &salt, const std::string &info, const std::size_t length);
+	// `Mac`: HMAC<Hash, BlockSize>, e.g. PBKDF2<HMAC<SHA2_256, 64>>(...)
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+namespace KDF_NS
+{
+	using Byte = uint8_t;
+
+	template <typename Mac>
+	void pbkdf2Block(const Mac &prf, const std::string &salt, const uint32_t iterations, const uint32_t index, Byte *out, const std::size_t length)
+	{
+		// T_i = U_1 ^ U_2 ^ ... ^ U_c, where U_1 = PRF(P, S || INT(i)), U_j = PRF(P, U_{j-1})
+		Mac mac = prf;  // keyed midstates are copied, the password is never rehashed
+		const Byte counter[4] = {static_cast<Byte>(index >> 24), static_cast<Byte>(index >> 16), static_cast<Byte>(index >> 8), static_cast<Byte>(index)};
+		mac.addData(salt.data(), salt.size());
+		mac.addData(counter);
+
+		// U and T live on the stack, an iteration makes no allocation
+		const auto first = mac.finalize().toSpan();
+		const std::size_t hashLength = first.size();
+		Byte u[Mac::MAX_DIGEST_SIZE];
+		Byte t[Mac::MAX_DIGEST_SIZE];
+		std::copy_n(first.begin(), hashLength, u);
+		std::copy_n(first.begin(), hashLength, t);
+
+		for (uint32_t j = 1; j < iterations; ++j)
+		{
+			mac.reset();
+			mac.addData(u, hashLength);
+			const auto next = mac.finalize().toSpan();
+			for (std::size_t k = 0; k < hashLength; ++k)
+			{
+				u[k] = next[k];
+				t[k] ^= u[k];
+			}
+		}
+		std::copy_n(t, std::min(length, hashLength), out);
+	}
+
+	template <typename Mac>
+	std::vector<Byte> pbkdf2(const std::string &password, const std::string &salt, const uint32_t iterations, const std::size_t length, const unsigned int maxThreads)
+	{
+		// https://tools.ietf.org/html/rfc8018#section-5.2
+
+		if (iterations == 0)
+			throw std::invalid_argument("PBKDF2 iteration count must be positive");
+
+		const Mac prf(password);
+		const std::size_t hashLength = Mac(prf).finalize().toSpan().size();
+		const std::size_t blocks = (length + hashLength - 1) / hashLength;
+		if (blocks > UINT32_MAX)
+			throw std::invalid_argument("PBKDF2 derived key too long");
+
+		std::vector<Byte> ret(length);
+		const auto derive = [&](const std::size_t first, const std::size_t last)
+		{
+			for (std::size_t i = first; i < last; ++i)
+			{
+				const std::size_t offset = i * hashLength;
+				pbkdf2Block(prf, salt, iterations, static_cast<uint32_t>(i + 1), (ret.data() + offset), (length - offset));
+			}
+		};
+
+		// output blocks are independent: the longer keys derive on worker threads
+		const std::size_t threads = std::min<std::size_t>(std::max(1u, maxThreads), blocks);
+		if (threads < 2)
+		{
+			derive(0, blocks);
+			return ret;
+		}
+
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+		const std::size_t share = (blocks + threads - 1) / threads;
+		for (std::size_t t = 0; t < threads; ++t)
+		{
+			const std::size_t first = t * share;
+			const std::size_t last = std::min(blocks, (first + share));
+			if (first < last)
+				workers.emplace_back(derive, first, last);
+		}
+		for (auto &worker : workers)
+			worker.join();
+
+		return ret;
+	}
+
+	template <typename Mac>
+	std::vector<Byte> hkdf(const std::string &ikm, const std::string &salt, const std::string &info, const std::size_t length)
+	{
+		// https://tools.ietf.org/html/rfc5869
+		// empty salt equals HashLen zeros: HMAC pads the key with zeros anyway
+
+		const std::vector<Byte> prk = Mac(salt).addData(ikm.data(), ikm.size()).finalize().toVector();
+		const Mac prf(std::string(prk.begin(), prk.end()));
+
+		if (length > (255 * prk.size()))
+			throw std::invalid_argument("HKDF output longer than 255 * HashLen");
+
+		std::vector<Byte> ret;
+		ret.reserve(length);
+		std::vector<Byte> t;
+		for (Byte i = 1; ret.size() < length; ++i)
+		{
+			Mac mac = prf;
+			mac.addData(t.data(), t.size());
+			mac.addData(info.data(), info.size());
+			mac.addData(&i, 1);
+			t = mac.finalize().toVector();
+			ret.insert(ret.end(), t.begin(), (t.begin() + std::min(t.size(), (length - ret.size()))));
+		}
+		return ret;
+	}
+}
+}
+
+	template <typename Mac>
+	std::vector<uint8_t> PBKDF2(const std::string &password, const std::string &salt, const uint32_t iterations, const std::size_t length, const unsigned int maxThreads = 1)
+	{
+		return Hash::KDF_NS::pbkdf2<Mac>(password, salt, iterations, length, maxThreads);
+	}
+
+	template <typename Mac>
+	std::vector<uint8_t> HKDF(const std::string &ikm, const std::string &salt, const std::string &info, const std::size_t length)
+	{
+		return Hash::KDF_NS::hkdf<Mac>(ikm, salt, info, length);
+	}
+}
+
+#endif  // CHOCOBO1_KDF_H
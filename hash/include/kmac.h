@@ -0,0 +1,308 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_KMAC_H
+#define CHOCOBO1_KMAC_H
+
+#include "cshake.h"
+
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// KMAC_128(const int digestLengthInBytes, const std::string &key, const std::string &customize = {});
+	// KMAC_256(const int digestLengthInBytes, const std::string &key, const std::string &customize = {});
+
+	// KMACXOF_128(const int digestLengthInBytes, const std::string &key, const std::string &customize = {});
+	// KMACXOF_256(const int digestLengthInBytes, const std::string &key, const std::string &customize = {});
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+#ifndef CHOCOBO1_HASH_ROR_IMPL
+#define CHOCOBO1_HASH_ROR_IMPL
+	template <typename R, typename T>
+	constexpr R ror(const T x, const unsigned int s)
+	{
+		static_assert(std::is_unsigned<R>::value, "");
+		static_assert(std::is_unsigned<T>::value, "");
+		return static_cast<R>(x >> s);
+	}
+#endif
+
+
+namespace KMAC_NS
+{
+	template <typename Alg, int W, bool XOF>  // `W`: rate of `Alg` in bytes. `XOF`: arbitrary-length output variant
+	class KMAC
+	{
+		// https://doi.org/10.6028/NIST.SP.800-185
+
+		public:
+			using Byte = uint8_t;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			KMAC(const int digestLength, const std::string &key, const std::string &customize = {});
+
+			void reset();  // back to the state right after the key was absorbed
+			KMAC& finalize();  // after this, only `operator T()`, `reset()`, `squeeze()`, `toString()`, `toVector()` are available
+			void squeeze(void *ptr, const std::size_t length);  // extendable output following the digest
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			template <typename T>
+			operator T() const noexcept;
+
+			KMAC& addData(const Span<const Byte> inData);
+			KMAC& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			KMAC& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			KMAC& addData(const T (&array)[N]);
+			template <typename T>
+			KMAC& addData(const Span<T> inSpan);
+
+		private:
+			int m_digestLength = 0;
+
+			Alg m_keyed;  // cSHAKE state after bytepad(encode_string(K), W), the cost of the key is paid once
+			Alg m_cshake;
+	};
+
+
+	// helpers
+	const auto rightEncode = [](const uint64_t value) -> Buffer<uint8_t, (sizeof(value) + 1)>
+	{
+		uint8_t n = 0;
+		for (uint64_t v = value; v > 0; v >>= 8)
+			++n;
+		if (n == 0)
+			n = 1;
+
+		Buffer<uint8_t, (sizeof(value) + 1)> ret;
+		for (int i = (n - 1); i >= 0; --i)
+			ret.fill(ror<uint8_t>(value, (8 * i)));
+		ret.fill(n);
+
+		return ret;
+	};
+
+
+	//
+	template <typename Alg, int W, bool XOF>
+	KMAC<Alg, W, XOF>::KMAC(const int digestLength, const std::string &key, const std::string &customize)
+		: m_digestLength(digestLength)
+		, m_keyed(digestLength, "KMAC", customize)
+		, m_cshake(digestLength, "KMAC", customize)
+	{
+		static_assert((W > 0), "Template parameter value invalid: W");
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+
+		// bytepad(encode_string(K), W)
+		const auto encodedW = CShake_NS::leftEncode(W);
+		m_keyed.addData({encodedW.data(), encodedW.size()});
+		const auto encodedK = CShake_NS::leftEncode(key.size() * 8);
+		m_keyed.addData({encodedK.data(), encodedK.size()});
+		m_keyed.addData(key.data(), key.size());
+
+		const std::size_t length = encodedW.size() + encodedK.size() + key.size();
+		const std::vector<Byte> zeros(((W - (length % W)) % W), 0);
+		m_keyed.addData(zeros.data(), zeros.size());
+
+		reset();
+	}
+
+	template <typename Alg, int W, bool XOF>
+	void KMAC<Alg, W, XOF>::reset()
+	{
+		m_cshake = m_keyed;
+	}
+
+	template <typename Alg, int W, bool XOF>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::finalize()
+	{
+		const auto encodedL = rightEncode(XOF ? 0 : (static_cast<uint64_t>(m_digestLength) * 8));
+		m_cshake.addData({encodedL.data(), encodedL.size()});
+		m_cshake.finalize();
+		return (*this);
+	}
+
+	template <typename Alg, int W, bool XOF>
+	void KMAC<Alg, W, XOF>::squeeze(void *ptr, const std::size_t length)
+	{
+		m_cshake.squeeze(ptr, length);
+	}
+
+	template <typename Alg, int W, bool XOF>
+	std::string KMAC<Alg, W, XOF>::toString() const
+	{
+		return m_cshake.toString();
+	}
+
+	template <typename Alg, int W, bool XOF>
+	std::vector<typename KMAC<Alg, W, XOF>::Byte> KMAC<Alg, W, XOF>::toVector() const
+	{
+		return m_cshake.toVector();
+	}
+
+	template <typename Alg, int W, bool XOF>
+	template <typename T>
+	KMAC<Alg, W, XOF>::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		const auto digest = toVector();
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), digest.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= digest[i];
+		}
+		return ret;
+	}
+
+	template <typename Alg, int W, bool XOF>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::addData(const Span<const Byte> inData)
+	{
+		m_cshake.addData(inData);
+		return (*this);
+	}
+
+	template <typename Alg, int W, bool XOF>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <typename Alg, int W, bool XOF>
+	template <std::size_t N>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <typename Alg, int W, bool XOF>
+	template <typename T, std::size_t N>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <typename Alg, int W, bool XOF>
+	template <typename T>
+	KMAC<Alg, W, XOF>& KMAC<Alg, W, XOF>::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+}
+}
+
+	template <typename Base>
+	struct KMACAlias : Base
+	{
+		using BaseType = Base;
+		KMACAlias(const int l, const std::string &k, const std::string &c = {}) : Base(l, k, c) {}
+		KMACAlias(const Base &other) : Base(other) {}
+		KMACAlias(Base &&other) noexcept : Base(std::move(other)) {}
+		KMACAlias& operator=(const Base &other) { if (this != &other) { Base::operator=(other); } return *this; }
+		KMACAlias& operator=(Base &&other) noexcept { if (this != &other) { Base::operator=(std::move(other)); } return *this; }
+	};
+	using KMAC_128 = KMACAlias<Hash::KMAC_NS::KMAC<CSHAKE_128, (1344 / 8), false>>;
+	using KMAC_256 = KMACAlias<Hash::KMAC_NS::KMAC<CSHAKE_256, (1088 / 8), false>>;
+	using KMACXOF_128 = KMACAlias<Hash::KMAC_NS::KMAC<CSHAKE_128, (1344 / 8), true>>;
+	using KMACXOF_256 = KMACAlias<Hash::KMAC_NS::KMAC<CSHAKE_256, (1088 / 8), true>>;
+}
+
+namespace std
+{
+	template <typename Alg, int W, bool XOF>
+	struct hash<Chocobo1::Hash::KMAC_NS::KMAC<Alg, W, XOF>>
+	{
+		size_t operator()(const Chocobo1::Hash::KMAC_NS::KMAC<Alg, W, XOF> &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::KMAC_128>
+	{
+		size_t operator()(const Chocobo1::KMAC_128 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::KMAC_256>
+	{
+		size_t operator()(const Chocobo1::KMAC_256 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::KMACXOF_128>
+	{
+		size_t operator()(const Chocobo1::KMACXOF_128 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+
+	template <>
+	struct hash<Chocobo1::KMACXOF_256>
+	{
+		size_t operator()(const Chocobo1::KMACXOF_256 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_KMAC_H
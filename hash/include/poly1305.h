@@ -0,0 +1,343 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_POLY1305_H
+#define CHOCOBO1_POLY1305_H
+
+#include <array>
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// Poly1305(const std::string &key);  // 32 bytes one-time key: r || s
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+namespace Poly1305_NS
+{
+	class Poly1305
+	{
+		// https://tools.ietf.org/html/rfc8439#section-2.5
+		// 26-bit limbs, 32x32 -> 64 bit multiplies only
+
+		public:
+			using Byte = uint8_t;
+			using ResultArrayType = std::array<Byte, 16>;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			explicit Poly1305(const std::string &key);
+
+			void reset();  // back to the keyed state, the clamped r and s are kept
+			Poly1305& finalize();  // after this, only `operator T()`, `reset()`, `toArray()`, `toString()`, `toVector()` are available
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			ResultArrayType toArray() const;
+			template <typename T>
+			operator T() const noexcept;
+
+			Poly1305& addData(const Span<const Byte> inData);
+			Poly1305& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			Poly1305& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			Poly1305& addData(const T (&array)[N]);
+			template <typename T>
+			Poly1305& addData(const Span<T> inSpan);
+
+		private:
+			void addDataImpl(const Byte *data, const std::size_t blocks, const uint32_t hibit);
+
+			static uint32_t load32(const Byte *p)
+			{
+				return (static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8)
+					| (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24));
+			}
+
+			static constexpr int BLOCK_SIZE = 16;
+
+			Byte m_buffer[BLOCK_SIZE] = {};
+			std::size_t m_bufferSize = 0;
+
+			uint32_t m_r[5] = {};
+			uint32_t m_pad[4] = {};
+			uint32_t m_h[5] = {};
+
+			ResultArrayType m_tag = {};
+	};
+
+
+	//
+	inline Poly1305::Poly1305(const std::string &key)
+	{
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+
+		if (key.size() != 32)
+			throw std::invalid_argument("Poly1305 key must be 32 bytes");
+
+		const Byte *k = reinterpret_cast<const Byte *>(key.data());
+
+		// r &= 0xffffffc0ffffffc0ffffffc0fffffff
+		m_r[0] = (load32(k + 0)) & 0x3ffffff;
+		m_r[1] = (load32(k + 3) >> 2) & 0x3ffff03;
+		m_r[2] = (load32(k + 6) >> 4) & 0x3ffc0ff;
+		m_r[3] = (load32(k + 9) >> 6) & 0x3f03fff;
+		m_r[4] = (load32(k + 12) >> 8) & 0x00fffff;
+
+		for (int i = 0; i < 4; ++i)
+			m_pad[i] = load32(k + 16 + (4 * i));
+	}
+
+	inline void Poly1305::reset()
+	{
+		m_bufferSize = 0;
+		for (auto &h : m_h)
+			h = 0;
+	}
+
+	inline Poly1305& Poly1305::finalize()
+	{
+		if (m_bufferSize > 0)  // the last partial block: append 1, pad with zeros, no 2^128 bit
+		{
+			m_buffer[m_bufferSize++] = 1;
+			for (std::size_t i = m_bufferSize; i < BLOCK_SIZE; ++i)
+				m_buffer[i] = 0;
+			addDataImpl(m_buffer, 1, 0);
+			m_bufferSize = 0;
+		}
+
+		uint32_t h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+
+		// fully carry h
+		uint32_t c = h1 >> 26; h1 &= 0x3ffffff;
+		h2 += c; c = h2 >> 26; h2 &= 0x3ffffff;
+		h3 += c; c = h3 >> 26; h3 &= 0x3ffffff;
+		h4 += c; c = h4 >> 26; h4 &= 0x3ffffff;
+		h0 += c * 5; c = h0 >> 26; h0 &= 0x3ffffff;
+		h1 += c;
+
+		// compute h - p = h + 5 - 2^130 and select it when it does not borrow
+		uint32_t g0 = h0 + 5; c = g0 >> 26; g0 &= 0x3ffffff;
+		uint32_t g1 = h1 + c; c = g1 >> 26; g1 &= 0x3ffffff;
+		uint32_t g2 = h2 + c; c = g2 >> 26; g2 &= 0x3ffffff;
+		uint32_t g3 = h3 + c; c = g3 >> 26; g3 &= 0x3ffffff;
+		uint32_t g4 = h4 + c - (1UL << 26);
+
+		uint32_t mask = (g4 >> 31) - 1;
+		g0 &= mask; g1 &= mask; g2 &= mask; g3 &= mask; g4 &= mask;
+		mask = ~mask;
+		h0 = (h0 & mask) | g0; h1 = (h1 & mask) | g1; h2 = (h2 & mask) | g2; h3 = (h3 & mask) | g3; h4 = (h4 & mask) | g4;
+
+		// h = (h + s) % 2^128
+		h0 = (h0 | (h1 << 26));
+		h1 = ((h1 >> 6) | (h2 << 20));
+		h2 = ((h2 >> 12) | (h3 << 14));
+		h3 = ((h3 >> 18) | (h4 << 8));
+
+		uint64_t f = static_cast<uint64_t>(h0) + m_pad[0]; h0 = static_cast<uint32_t>(f);
+		f = static_cast<uint64_t>(h1) + m_pad[1] + (f >> 32); h1 = static_cast<uint32_t>(f);
+		f = static_cast<uint64_t>(h2) + m_pad[2] + (f >> 32); h2 = static_cast<uint32_t>(f);
+		f = static_cast<uint64_t>(h3) + m_pad[3] + (f >> 32); h3 = static_cast<uint32_t>(f);
+
+		const uint32_t words[4] = {h0, h1, h2, h3};
+		for (int i = 0; i < 16; ++i)
+			m_tag[i] = static_cast<Byte>(words[i / 4] >> (8 * (i % 4)));
+
+		return (*this);
+	}
+
+	inline std::string Poly1305::toString() const
+	{
+		std::string ret;
+		ret.reserve(2 * m_tag.size());
+		for (const auto c : m_tag)
+		{
+			const Byte upper = static_cast<Byte>(c >> 4);
+			ret.push_back(static_cast<char>((upper < 10) ? (upper + '0') : (upper - 10 + 'a')));
+
+			const Byte lower = c & 0xf;
+			ret.push_back(static_cast<char>((lower < 10) ? (lower + '0') : (lower - 10 + 'a')));
+		}
+		return ret;
+	}
+
+	inline std::vector<Poly1305::Byte> Poly1305::toVector() const
+	{
+		return {m_tag.begin(), m_tag.end()};
+	}
+
+	inline Poly1305::ResultArrayType Poly1305::toArray() const
+	{
+		return m_tag;
+	}
+
+	template <typename T>
+	Poly1305::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), m_tag.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= m_tag[i];
+		}
+		return ret;
+	}
+
+	inline Poly1305& Poly1305::addData(const Span<const Byte> inData)
+	{
+		const Byte *data = inData.data();
+		std::size_t size = inData.size();
+
+		if (m_bufferSize > 0)
+		{
+			const std::size_t len = std::min<std::size_t>((BLOCK_SIZE - m_bufferSize), size);  // try fill to BLOCK_SIZE bytes
+			for (std::size_t i = 0; i < len; ++i)
+				m_buffer[m_bufferSize + i] = data[i];
+			m_bufferSize += len;
+			data += len;
+			size -= len;
+
+			if (m_bufferSize < BLOCK_SIZE)  // still doesn't fill the buffer
+				return (*this);
+
+			addDataImpl(m_buffer, 1, (1UL << 24));
+			m_bufferSize = 0;
+		}
+
+		const std::size_t blocks = size / BLOCK_SIZE;
+		addDataImpl(data, blocks, (1UL << 24));
+		data += (blocks * BLOCK_SIZE);
+		size -= (blocks * BLOCK_SIZE);
+
+		for (std::size_t i = 0; i < size; ++i)
+			m_buffer[i] = data[i];
+		m_bufferSize = size;
+
+		return (*this);
+	}
+
+	inline Poly1305& Poly1305::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <std::size_t N>
+	Poly1305& Poly1305::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <typename T, std::size_t N>
+	Poly1305& Poly1305::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <typename T>
+	Poly1305& Poly1305::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+
+	inline void Poly1305::addDataImpl(const Byte *data, const std::size_t blocks, const uint32_t hibit)
+	{
+		const uint32_t r0 = m_r[0], r1 = m_r[1], r2 = m_r[2], r3 = m_r[3], r4 = m_r[4];
+		const uint32_t s1 = r1 * 5, s2 = r2 * 5, s3 = r3 * 5, s4 = r4 * 5;
+		uint32_t h0 = m_h[0], h1 = m_h[1], h2 = m_h[2], h3 = m_h[3], h4 = m_h[4];
+
+		for (std::size_t i = 0; i < blocks; ++i, data += BLOCK_SIZE)
+		{
+			// h += m[i]
+			h0 += (load32(data + 0)) & 0x3ffffff;
+			h1 += (load32(data + 3) >> 2) & 0x3ffffff;
+			h2 += (load32(data + 6) >> 4) & 0x3ffffff;
+			h3 += (load32(data + 9) >> 6) & 0x3ffffff;
+			h4 += (load32(data + 12) >> 8) | hibit;
+
+			// h *= r
+			const uint64_t d0 = (static_cast<uint64_t>(h0) * r0) + (static_cast<uint64_t>(h1) * s4) + (static_cast<uint64_t>(h2) * s3) + (static_cast<uint64_t>(h3) * s2) + (static_cast<uint64_t>(h4) * s1);
+			uint64_t d1 = (static_cast<uint64_t>(h0) * r1) + (static_cast<uint64_t>(h1) * r0) + (static_cast<uint64_t>(h2) * s4) + (static_cast<uint64_t>(h3) * s3) + (static_cast<uint64_t>(h4) * s2);
+			uint64_t d2 = (static_cast<uint64_t>(h0) * r2) + (static_cast<uint64_t>(h1) * r1) + (static_cast<uint64_t>(h2) * r0) + (static_cast<uint64_t>(h3) * s4) + (static_cast<uint64_t>(h4) * s3);
+			uint64_t d3 = (static_cast<uint64_t>(h0) * r3) + (static_cast<uint64_t>(h1) * r2) + (static_cast<uint64_t>(h2) * r1) + (static_cast<uint64_t>(h3) * r0) + (static_cast<uint64_t>(h4) * s4);
+			uint64_t d4 = (static_cast<uint64_t>(h0) * r4) + (static_cast<uint64_t>(h1) * r3) + (static_cast<uint64_t>(h2) * r2) + (static_cast<uint64_t>(h3) * r1) + (static_cast<uint64_t>(h4) * r0);
+
+			// (partial) h %= p
+			uint32_t c = static_cast<uint32_t>(d0 >> 26); h0 = static_cast<uint32_t>(d0) & 0x3ffffff;
+			d1 += c; c = static_cast<uint32_t>(d1 >> 26); h1 = static_cast<uint32_t>(d1) & 0x3ffffff;
+			d2 += c; c = static_cast<uint32_t>(d2 >> 26); h2 = static_cast<uint32_t>(d2) & 0x3ffffff;
+			d3 += c; c = static_cast<uint32_t>(d3 >> 26); h3 = static_cast<uint32_t>(d3) & 0x3ffffff;
+			d4 += c; c = static_cast<uint32_t>(d4 >> 26); h4 = static_cast<uint32_t>(d4) & 0x3ffffff;
+			h0 += c * 5; c = (h0 >> 26); h0 &= 0x3ffffff;
+			h1 += c;
+		}
+
+		m_h[0] = h0; m_h[1] = h1; m_h[2] = h2; m_h[3] = h3; m_h[4] = h4;
+	}
+}
+}
+
+	using Poly1305 = Hash::Poly1305_NS::Poly1305;
+}
+
+namespace std
+{
+	template <>
+	struct hash<Chocobo1::Poly1305>
+	{
+		size_t operator()(const Chocobo1::Poly1305 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_POLY1305_H
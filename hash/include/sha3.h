@@ -195,7 +195,7 @@ namespace Hash
 
 namespace SHA3_NS
 {
-	template<int R, int P>  // `R`: see m_params. `P`: suffix + padding
+	template<int R, int P, int NR = 24>  // `R`: see m_params. `P`: suffix + padding. `NR`: number of rounds
 	class Keccak
 	{
 		// https://dx.doi.org/10.6028/NIST.FIPS.202
@@ -215,10 +215,12 @@ namespace SHA3_NS
 			constexpr explicit Keccak(const int digestLength);
 
 			constexpr void reset();
-			Keccak& finalize();  // after this, only `operator T()`, `reset()`, `toString()`, `toVector()` are available
+			Keccak& finalize();  // after this, only `operator T()`, `reset()`, `squeeze()`, `toString()`, `toVector()` are available
+			void squeeze(void *ptr, const std::size_t length);  // extendable output following the digest
 
 			std::string toString() const;
 			std::vector<Byte> toVector() const;
+			Span<const Byte> toSpan() const;  // view of the digest, valid until `reset()`
 			template <typename T>
 			operator T() const noexcept;
 
@@ -233,7 +235,6 @@ namespace SHA3_NS
 
 		private:
 			constexpr void addDataImpl(const Span<const Byte> data);
-			std::vector<typename Keccak::Byte> stateToVector() const;
 
 			struct
 			{
@@ -248,6 +249,7 @@ namespace SHA3_NS
 				int w = 64;       // (b / 25)
 			} m_params;
 			int m_digestLength;
+			int m_squeezeIdx = 0;  // bytes already taken from the current output block
 
 			Buffer<Byte, R> m_buffer;
 			std::vector<Byte> m_final;
@@ -289,32 +291,34 @@ namespace SHA3_NS
 
 
 	//
-	template <int R, int P>
-	constexpr Keccak<R, P>::Keccak(const int digestLength)
+	template <int R, int P, int NR>
+	constexpr Keccak<R, P, NR>::Keccak(const int digestLength)
 		: m_params()
 		, m_digestLength(digestLength)
 	{
 		static_assert((R >= 0), "Template parameter value invalid: R");
 		static_assert((P >= 0), "Template parameter value invalid: P");
+		static_assert(((NR > 0) && (NR <= 24)), "Template parameter value invalid: NR");
 		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
 
 		m_final.reserve(m_digestLength);
 		reset();
 	}
 
-	template <int R, int P>
-	constexpr void Keccak<R, P>::reset()
+	template <int R, int P, int NR>
+	constexpr void Keccak<R, P, NR>::reset()
 	{
 		m_buffer.clear();
 		m_final.clear();
+		m_squeezeIdx = 0;
 
 		for (int y = 0; y < 5; ++y)
 			for (int x = 0; x < 5; ++x)
 				m_state[y][x] = 0;
 	}
 
-	template <int R, int P>
-	Keccak<R, P>& Keccak<R, P>::finalize()
+	template <int R, int P, int NR>
+	Keccak<R, P, NR>& Keccak<R, P, NR>::finalize()
 	{
 		// add padding
 		// the padding is reversed due to "B.1 Conversion Functions - Algorithm 11: b2h(S)"
@@ -327,23 +331,34 @@ namespace SHA3_NS
 		addDataImpl({m_buffer.data(), m_buffer.size()});
 		m_buffer.clear();
 
-		// squish out
-		while (true)
+		// squish out, straight into the storage reserved by the constructor
+		m_final.resize(m_digestLength);
+		m_squeezeIdx = 0;
+		squeeze(m_final.data(), m_final.size());
+		return (*this);
+	}
+
+	template <int R, int P, int NR>
+	void Keccak<R, P, NR>::squeeze(void *ptr, const std::size_t length)
+	{
+		const uint64_t *statePtr = reinterpret_cast<const uint64_t *>(m_state);
+		Byte *out = static_cast<Byte *>(ptr);
+
+		for (std::size_t i = 0; i < length; ++i)
 		{
-			const std::vector<Byte> state = stateToVector();
-			m_final.insert(m_final.end(), state.begin(), (state.begin() + R));
-			if (m_final.size() >= static_cast<size_t>(m_digestLength))
-				break;
+			if (m_squeezeIdx == R)
+			{
+				addDataImpl(std::array<Byte, R> {});
+				m_squeezeIdx = 0;
+			}
 
-			addDataImpl(std::array<Byte, R> {});
+			*(out++) = ror<Byte>(statePtr[m_squeezeIdx / 8], ((m_squeezeIdx % 8) * 8));
+			++m_squeezeIdx;
 		}
-
-		m_final.resize(m_digestLength);
-		return (*this);
 	}
 
-	template <int R, int P>
-	std::string Keccak<R, P>::toString() const
+	template <int R, int P, int NR>
+	std::string Keccak<R, P, NR>::toString() const
 	{
 		const auto v = toVector();
 		std::string ret;
@@ -362,15 +377,21 @@ namespace SHA3_NS
 		return ret;
 	}
 
-	template <int R, int P>
-	std::vector<typename Keccak<R, P>::Byte> Keccak<R, P>::toVector() const
+	template <int R, int P, int NR>
+	std::vector<typename Keccak<R, P, NR>::Byte> Keccak<R, P, NR>::toVector() const
 	{
 		return m_final;
 	}
 
-	template <int R, int P>
+	template <int R, int P, int NR>
+	typename Keccak<R, P, NR>::template Span<const typename Keccak<R, P, NR>::Byte> Keccak<R, P, NR>::toSpan() const
+	{
+		return {m_final.data(), m_final.size()};
+	}
+
+	template <int R, int P, int NR>
 	template <typename T>
-	Keccak<R, P>::operator T() const noexcept
+	Keccak<R, P, NR>::operator T() const noexcept
 	{
 		static_assert(std::is_unsigned<T>::value, "");
 
@@ -384,8 +405,8 @@ namespace SHA3_NS
 		return ret;
 	}
 
-	template <int R, int P>
-	constexpr Keccak<R, P>& Keccak<R, P>::addData(const Span<const Byte> inData)
+	template <int R, int P, int NR>
+	constexpr Keccak<R, P, NR>& Keccak<R, P, NR>::addData(const Span<const Byte> inData)
 	{
 		Span<const Byte> data = inData;
 
@@ -419,36 +440,36 @@ namespace SHA3_NS
 		return (*this);
 	}
 
-	template <int R, int P>
-	constexpr Keccak<R, P>& Keccak<R, P>::addData(const void *ptr, const std::size_t length)
+	template <int R, int P, int NR>
+	constexpr Keccak<R, P, NR>& Keccak<R, P, NR>::addData(const void *ptr, const std::size_t length)
 	{
 		// Span::size_type = std::size_t
 		return addData({static_cast<const Byte*>(ptr), length});
 	}
 
-	template <int R, int P>
+	template <int R, int P, int NR>
 	template <std::size_t N>
-	constexpr Keccak<R, P>& Keccak<R, P>::addData(const Byte (&array)[N])
+	constexpr Keccak<R, P, NR>& Keccak<R, P, NR>::addData(const Byte (&array)[N])
 	{
 		return addData({array, N});
 	}
 
-	template <int R, int P>
+	template <int R, int P, int NR>
 	template <typename T, std::size_t N>
-	Keccak<R, P>& Keccak<R, P>::addData(const T (&array)[N])
+	Keccak<R, P, NR>& Keccak<R, P, NR>::addData(const T (&array)[N])
 	{
 		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
 	}
 
-	template <int R, int P>
+	template <int R, int P, int NR>
 	template <typename T>
-	Keccak<R, P>& Keccak<R, P>::addData(const Span<T> inSpan)
+	Keccak<R, P, NR>& Keccak<R, P, NR>::addData(const Span<T> inSpan)
 	{
 		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
 	}
 
-	template <int R, int P>
-	constexpr void Keccak<R, P>::addDataImpl(const Span<const Byte> data)
+	template <int R, int P, int NR>
+	constexpr void Keccak<R, P, NR>::addDataImpl(const Span<const Byte> data)
 	{
 		assert((data.size() % R) == 0);
 
@@ -560,27 +581,11 @@ namespace SHA3_NS
 				iota(indexRound);
 			};
 
-			for (int i = 0; i < 24; ++i)
+			// Keccak-p[1600, NR] runs the last `NR` rounds of Keccak-f[1600]
+			for (int i = (24 - NR); i < 24; ++i)
 				roundFunction(i);
 		}
 	}
-
-	template <int R, int P>
-	std::vector<typename Keccak<R, P>::Byte> Keccak<R, P>::stateToVector() const
-	{
-		const Span<const uint64_t> state(reinterpret_cast<const uint64_t *>(m_state), 25);
-		const int dataSize = sizeof(typename decltype(state)::value_type);
-
-		std::vector<Byte> ret;
-		ret.reserve(dataSize * state.size());
-		for (const auto i : state)
-		{
-			for (int j = 0; j < dataSize; ++j)
-				ret.emplace_back(ror<Byte>(i, (j * 8)));
-		}
-
-		return ret;
-	}
 }
 }
 
@@ -615,10 +620,10 @@ namespace SHA3_NS
 
 namespace std
 {
-	template <int R, int P>
-	struct hash<Chocobo1::Hash::SHA3_NS::Keccak<R, P>>
+	template <int R, int P, int NR>
+	struct hash<Chocobo1::Hash::SHA3_NS::Keccak<R, P, NR>>
 	{
-		size_t operator()(const Chocobo1::Hash::SHA3_NS::Keccak<R, P> &hash) const noexcept
+		size_t operator()(const Chocobo1::Hash::SHA3_NS::Keccak<R, P, NR> &hash) const noexcept
 		{
 			return hash;
 		}
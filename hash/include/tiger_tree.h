@@ -0,0 +1,378 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_TIGER_TREE_H
+#define CHOCOBO1_TIGER_TREE_H
+
+#include "tiger.h"
+
+#include <algorithm>
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// TigerTree();
+	// TigerTree2();
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+namespace TigerTree_NS
+{
+	template <int V>  // Tiger version of the nodes: [1, 2]
+	class TigerTree
+	{
+		// https://adc.sourceforge.io/draft-jchapweske-thex-02.html
+
+		public:
+			using Byte = uint8_t;
+			using ResultArrayType = std::array<Byte, 24>;
+			using Level = std::vector<ResultArrayType>;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			TigerTree();
+
+			void reset();
+			TigerTree& finalize();  // after this, only `operator T()`, `reset()`, `levels()`, `toArray()`, `toString()`, `toVector()` are available
+
+			void setMaxThreads(const unsigned int threads);  // 1, the default, disables parallel leaf hashing
+			void setKeepLevels(const bool keep);  // keep every tree level for `levels()`, off by default
+			const std::vector<Level>& levels() const;  // [0] are the leaves, back() is the root
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			ResultArrayType toArray() const;
+			template <typename T>
+			operator T() const noexcept;
+
+			TigerTree& addData(const Span<const Byte> inData);
+			TigerTree& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			TigerTree& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			TigerTree& addData(const T (&array)[N]);
+			template <typename T>
+			TigerTree& addData(const Span<T> inSpan);
+
+		private:
+			using Node = Tiger_NS::Tiger<V, 192>;
+
+			static constexpr std::size_t LEAF_SIZE = 1024;
+			static constexpr std::size_t PARALLEL_LEAVES = 64;  // least number of leaves a worker thread is started for
+			static constexpr std::size_t BATCH_LEAVES = 1024;  // leaves collected from short inputs for one round of workers
+
+			void addLeaves(const Byte *data, const std::size_t leaves);
+			void flushBatch();
+			static ResultArrayType leafHash(const Byte *data, const std::size_t length);
+			static ResultArrayType innerHash(const ResultArrayType &left, const ResultArrayType &right);
+
+			std::vector<Byte> m_batch;  // with threads allowed, whole leaves are collected here so that short segments still hash in parallel
+			Level m_leaves;
+			std::vector<Level> m_levels;
+			ResultArrayType m_root = {};
+
+			unsigned int m_maxThreads = 1;
+			bool m_keepLevels = false;
+	};
+
+
+	//
+	template <int V>
+	TigerTree<V>::TigerTree()
+	{
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+	}
+
+	template <int V>
+	void TigerTree<V>::reset()
+	{
+		m_batch.clear();
+		m_leaves.clear();
+		m_levels.clear();
+		m_root = {};
+	}
+
+	template <int V>
+	TigerTree<V>& TigerTree<V>::finalize()
+	{
+		const std::size_t whole = m_batch.size() / LEAF_SIZE;
+		addLeaves(m_batch.data(), whole);
+
+		const std::size_t rest = m_batch.size() % LEAF_SIZE;
+		if ((rest > 0) || m_leaves.empty())  // the empty input is a single empty leaf
+			m_leaves.push_back(leafHash((m_batch.data() + (whole * LEAF_SIZE)), rest));
+		m_batch.clear();
+
+		// combine pairs level by level, an odd node is promoted unchanged
+		Level level = std::move(m_leaves);
+		m_leaves.clear();
+		while (level.size() > 1)
+		{
+			Level upper;
+			upper.reserve((level.size() + 1) / 2);
+			for (std::size_t i = 0; (i + 1) < level.size(); i += 2)
+				upper.push_back(innerHash(level[i], level[i + 1]));
+			if ((level.size() % 2) != 0)
+				upper.push_back(level.back());
+
+			if (m_keepLevels)
+				m_levels.push_back(std::move(level));
+			level = std::move(upper);
+		}
+
+		m_root = level.front();
+		if (m_keepLevels)
+			m_levels.push_back(std::move(level));
+
+		return (*this);
+	}
+
+	template <int V>
+	void TigerTree<V>::setMaxThreads(const unsigned int threads)
+	{
+		m_maxThreads = std::max(1u, threads);
+	}
+
+	template <int V>
+	void TigerTree<V>::setKeepLevels(const bool keep)
+	{
+		m_keepLevels = keep;
+	}
+
+	template <int V>
+	const std::vector<typename TigerTree<V>::Level>& TigerTree<V>::levels() const
+	{
+		return m_levels;
+	}
+
+	template <int V>
+	std::string TigerTree<V>::toString() const
+	{
+		std::string ret;
+		ret.reserve(2 * m_root.size());
+		for (const auto c : m_root)
+		{
+			const Byte upper = ror<Byte>(c, 4);
+			ret.push_back(static_cast<char>((upper < 10) ? (upper + '0') : (upper - 10 + 'a')));
+
+			const Byte lower = c & 0xf;
+			ret.push_back(static_cast<char>((lower < 10) ? (lower + '0') : (lower - 10 + 'a')));
+		}
+		return ret;
+	}
+
+	template <int V>
+	std::vector<typename TigerTree<V>::Byte> TigerTree<V>::toVector() const
+	{
+		return {m_root.begin(), m_root.end()};
+	}
+
+	template <int V>
+	typename TigerTree<V>::ResultArrayType TigerTree<V>::toArray() const
+	{
+		return m_root;
+	}
+
+	template <int V>
+	template <typename T>
+	TigerTree<V>::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), m_root.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= m_root[i];
+		}
+		return ret;
+	}
+
+	template <int V>
+	TigerTree<V>& TigerTree<V>::addData(const Span<const Byte> inData)
+	{
+		// with threads allowed a whole batch waits for one round of workers, serially only a partial leaf waits
+		const std::size_t batchSize = ((m_maxThreads < 2) ? 1 : BATCH_LEAVES) * LEAF_SIZE;
+		if (m_batch.size() >= batchSize)  // the threads were taken back
+			flushBatch();
+
+		Span<const Byte> data = inData;
+		while (!data.empty())
+		{
+			if (m_batch.empty() && (data.size() >= batchSize))  // large input is hashed in place
+			{
+				const std::size_t whole = data.size() / LEAF_SIZE;
+				addLeaves(data.data(), whole);
+				data = data.subspan(whole * LEAF_SIZE);
+				continue;
+			}
+
+			if (m_batch.capacity() < batchSize)
+				m_batch.reserve(batchSize);
+			const std::size_t len = std::min<std::size_t>((batchSize - m_batch.size()), data.size());
+			m_batch.insert(m_batch.end(), data.begin(), (data.begin() + len));
+			data = data.subspan(len);
+
+			if (m_batch.size() == batchSize)
+				flushBatch();
+		}
+
+		return (*this);
+	}
+
+	template <int V>
+	TigerTree<V>& TigerTree<V>::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <int V>
+	template <std::size_t N>
+	TigerTree<V>& TigerTree<V>::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <int V>
+	template <typename T, std::size_t N>
+	TigerTree<V>& TigerTree<V>::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <int V>
+	template <typename T>
+	TigerTree<V>& TigerTree<V>::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+
+	template <int V>
+	void TigerTree<V>::flushBatch()
+	{
+		const std::size_t whole = m_batch.size() / LEAF_SIZE;
+		addLeaves(m_batch.data(), whole);
+		m_batch.erase(m_batch.begin(), (m_batch.begin() + (whole * LEAF_SIZE)));
+	}
+
+	template <int V>
+	void TigerTree<V>::addLeaves(const Byte *data, const std::size_t leaves)
+	{
+		const std::size_t first = m_leaves.size();
+		m_leaves.resize(first + leaves);
+
+		const auto hashLeaves = [this, data, first](const std::size_t begin, const std::size_t end)
+		{
+			for (std::size_t i = begin; i < end; ++i)
+				m_leaves[first + i] = leafHash((data + (i * LEAF_SIZE)), LEAF_SIZE);
+		};
+
+		const std::size_t threads = std::min<std::size_t>(m_maxThreads, (leaves / PARALLEL_LEAVES));
+		if (threads < 2)
+		{
+			hashLeaves(0, leaves);
+			return;
+		}
+
+		// leaves are independent: hash them on worker threads, every worker owns a slice of m_leaves
+		std::vector<std::thread> workers;
+		workers.reserve(threads);
+
+		const std::size_t share = (leaves + threads - 1) / threads;
+		for (std::size_t t = 0; t < threads; ++t)
+		{
+			const std::size_t begin = t * share;
+			const std::size_t end = std::min(leaves, (begin + share));
+			if (begin < end)
+				workers.emplace_back(hashLeaves, begin, end);
+		}
+		for (auto &worker : workers)
+			worker.join();
+	}
+
+	template <int V>
+	typename TigerTree<V>::ResultArrayType TigerTree<V>::leafHash(const Byte *data, const std::size_t length)
+	{
+		const Byte prefix[1] = {0x00};
+		Node node;
+		node.addData(prefix);
+		node.addData(data, length);
+		return node.finalize().toArray();
+	}
+
+	template <int V>
+	typename TigerTree<V>::ResultArrayType TigerTree<V>::innerHash(const ResultArrayType &left, const ResultArrayType &right)
+	{
+		const Byte prefix[1] = {0x01};
+		Node node;
+		node.addData(prefix);
+		node.addData(left.data(), left.size());
+		node.addData(right.data(), right.size());
+		return node.finalize().toArray();
+	}
+}
+}
+
+	using TigerTree = Hash::TigerTree_NS::TigerTree<1>;
+	using TigerTree2 = Hash::TigerTree_NS::TigerTree<2>;
+}
+
+namespace std
+{
+	template <int V>
+	struct hash<Chocobo1::Hash::TigerTree_NS::TigerTree<V>>
+	{
+		size_t operator()(const Chocobo1::Hash::TigerTree_NS::TigerTree<V> &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_TIGER_TREE_H
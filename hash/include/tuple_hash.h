@@ -102,6 +102,10 @@ namespace TupleHash_NS
 			template <typename T>
 			TupleHash& nextData(const Span<T> inSpan);
 
+			constexpr TupleHash& nextElement(const std::size_t length);  // announce next element of `length` bytes, then pass it in parts with `addData()`
+			constexpr TupleHash& addData(const Span<const Byte> inData);
+			constexpr TupleHash& addData(const void *ptr, const std::size_t length);
+
 		private:
 			constexpr void addDataImpl(const Span<const Byte> data);
 
@@ -214,6 +218,29 @@ namespace TupleHash_NS
 		return nextData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
 	}
 
+	template <typename Alg>
+	constexpr TupleHash<Alg>& TupleHash<Alg>::nextElement(const std::size_t length)
+	{
+		const auto encoded = Chocobo1::Hash::CShake_NS::leftEncode(length * 8);
+		addDataImpl({encoded.data(), encoded.size()});
+
+		return (*this);
+	}
+
+	template <typename Alg>
+	constexpr TupleHash<Alg>& TupleHash<Alg>::addData(const Span<const Byte> inData)
+	{
+		addDataImpl(inData);
+		return (*this);
+	}
+
+	template <typename Alg>
+	constexpr TupleHash<Alg>& TupleHash<Alg>::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
 	template <typename Alg>
 	constexpr void TupleHash<Alg>::addDataImpl(const Span<const Byte> data)
 	{
@@ -0,0 +1,431 @@
+/*
+ *  Chocobo1/Hash
+ *
+ *   Copyright 2017-2020 by Mike Tzou (Chocobo1)
+ *     https://github.com/Chocobo1/Hash
+ *
+ *   Licensed under GNU General Public License 3 or later.
+ *
+ *  @license GPL3 <https://www.gnu.org/licenses/gpl-3.0-standalone.html>
+ */
+
+#ifndef CHOCOBO1_VMAC_H
+#define CHOCOBO1_VMAC_H
+
+#include "cshake.h"
+#include "siphash.h"
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if (__cplusplus > 201703L)
+#include <version>
+#endif
+
+#ifndef USE_STD_SPAN_CHOCOBO1_HASH
+#if (__cpp_lib_span >= 202002L)
+#define USE_STD_SPAN_CHOCOBO1_HASH 1
+#else
+#define USE_STD_SPAN_CHOCOBO1_HASH 0
+#endif
+#endif
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+#include <span>
+#else
+#include "gsl/span"
+#endif
+
+
+namespace Chocobo1
+{
+	// Use these!!
+	// VMAC_64(const std::string &key);
+	//   .setNonce(nonce) before `finalize()`, a nonce must never repeat under one key
+}
+
+
+namespace Chocobo1
+{
+// users should ignore things in this namespace
+namespace Hash
+{
+namespace VMAC_NS
+{
+	class VMAC
+	{
+		// VHASH style universal hash (https://tools.ietf.org/html/draft-krovetz-vmac-01):
+		//   NH over 128-byte blocks, polynomial over 2^127 - 1, inner product over 2^64 - 257.
+		// AES is not available here, so unlike VMAC-AES:
+		//   keys are squeezed from cSHAKE128(key, "", "VMAC"): 16 NH words, poly key, 2 L3 words, SipHash key
+		//   the tag is VHASH(message) + SipHash-2-4(nonce) mod 2^64
+
+		public:
+			using Byte = uint8_t;
+			using ResultArrayType = std::array<Byte, 8>;
+
+#if (USE_STD_SPAN_CHOCOBO1_HASH == 1)
+			template <typename T, std::size_t Extent = std::dynamic_extent>
+			using Span = std::span<T, Extent>;
+#else
+			template <typename T, std::size_t Extent = gsl::dynamic_extent>
+			using Span = gsl::span<T, Extent>;
+#endif
+
+
+			explicit VMAC(const std::string &key);
+
+			void reset();  // back to the keyed state, the derived keys are kept
+			VMAC& setNonce(const void *ptr, const std::size_t length);
+			VMAC& setNonce(const std::string &nonce);
+			VMAC& finalize();  // after this, only `operator T()`, `reset()`, `toArray()`, `toString()`, `toVector()` are available
+
+			std::string toString() const;
+			std::vector<Byte> toVector() const;
+			ResultArrayType toArray() const;
+			template <typename T>
+			operator T() const noexcept;
+
+			VMAC& addData(const Span<const Byte> inData);
+			VMAC& addData(const void *ptr, const std::size_t length);
+			template <std::size_t N>
+			VMAC& addData(const Byte (&array)[N]);
+			template <typename T, std::size_t N>
+			VMAC& addData(const T (&array)[N]);
+			template <typename T>
+			VMAC& addData(const Span<T> inSpan);
+
+		private:
+			struct Uint128
+			{
+				uint64_t hi;
+				uint64_t lo;
+			};
+
+			static constexpr int BLOCK_SIZE = 128;
+			static constexpr uint64_t M63 = 0x7FFFFFFFFFFFFFFF;
+			static constexpr uint64_t P64 = 0xFFFFFFFFFFFFFEFF;  // 2^64 - 257
+			static constexpr uint64_t MPOLY = 0x1FFFFFFF1FFFFFFF;
+			static constexpr Byte NO_KEY[16] = {};  // placeholder until the SipHash key is derived
+
+			static void mul64(const uint64_t a, const uint64_t b, uint64_t &hi, uint64_t &lo);
+			static uint64_t load64(const Byte *p);
+
+			void addDataImpl(const Byte *data, const std::size_t blocks);
+			void polyStep(const Uint128 &value);  // m_poly = (m_poly * k + value) % (2^127 - 1)
+			uint64_t l3Hash() const;
+
+			// keyed
+			uint64_t m_nhKey[BLOCK_SIZE / 8] = {};
+			Uint128 m_polyKey = {0, 0};
+			uint64_t m_l3Key[2] = {};
+			SipHash m_pad;
+
+			// per message
+			Byte m_buffer[BLOCK_SIZE] = {};
+			std::size_t m_bufferSize = 0;
+			uint64_t m_sizeCounter = 0;
+			Uint128 m_poly = {0, 1};
+			SipHash m_nonce;
+
+			ResultArrayType m_tag = {};
+	};
+
+
+	//
+	inline VMAC::VMAC(const std::string &key)
+		: m_pad(NO_KEY)
+		, m_nonce(NO_KEY)
+	{
+		static_assert((CHAR_BIT == 8), "Sorry, we don't support exotic CPUs");
+
+		Byte keys[(BLOCK_SIZE) + 16 + 16 + 16] = {};
+		CSHAKE_128 derive(0, "", "VMAC");
+		derive.addData(key.data(), key.size());
+		derive.finalize();
+		derive.squeeze(keys, sizeof(keys));
+
+		const Byte *k = keys;
+		for (auto &word : m_nhKey)
+		{
+			word = load64(k);
+			k += 8;
+		}
+		m_polyKey.hi = load64(k) & MPOLY;
+		m_polyKey.lo = load64(k + 8) & MPOLY;
+		k += 16;
+		m_l3Key[0] = load64(k) % P64;
+		m_l3Key[1] = load64(k + 8) % P64;
+		k += 16;
+		m_pad = SipHash(Span<const Byte>{k, 16});
+
+		reset();
+	}
+
+	inline void VMAC::reset()
+	{
+		m_bufferSize = 0;
+		m_sizeCounter = 0;
+		m_poly = {0, 1};
+		m_nonce = m_pad;
+	}
+
+	inline VMAC& VMAC::setNonce(const void *ptr, const std::size_t length)
+	{
+		m_nonce = m_pad;
+		m_nonce.addData(ptr, length);
+		return (*this);
+	}
+
+	inline VMAC& VMAC::setNonce(const std::string &nonce)
+	{
+		return setNonce(nonce.data(), nonce.size());
+	}
+
+	inline VMAC& VMAC::finalize()
+	{
+		if (m_bufferSize > 0)  // zero padded, the bit length below tells the paddings apart
+		{
+			for (std::size_t i = m_bufferSize; i < BLOCK_SIZE; ++i)
+				m_buffer[i] = 0;
+			addDataImpl(m_buffer, 1);
+			m_bufferSize = 0;
+		}
+		polyStep({0, (m_sizeCounter * 8)});
+
+		const uint64_t tag = l3Hash() + static_cast<uint64_t>(m_nonce.finalize());
+		for (int i = 0; i < 8; ++i)
+			m_tag[i] = static_cast<Byte>(tag >> (8 * (7 - i)));
+
+		return (*this);
+	}
+
+	inline std::string VMAC::toString() const
+	{
+		std::string ret;
+		ret.reserve(2 * m_tag.size());
+		for (const auto c : m_tag)
+		{
+			const Byte upper = static_cast<Byte>(c >> 4);
+			ret.push_back(static_cast<char>((upper < 10) ? (upper + '0') : (upper - 10 + 'a')));
+
+			const Byte lower = c & 0xf;
+			ret.push_back(static_cast<char>((lower < 10) ? (lower + '0') : (lower - 10 + 'a')));
+		}
+		return ret;
+	}
+
+	inline std::vector<VMAC::Byte> VMAC::toVector() const
+	{
+		return {m_tag.begin(), m_tag.end()};
+	}
+
+	inline VMAC::ResultArrayType VMAC::toArray() const
+	{
+		return m_tag;
+	}
+
+	template <typename T>
+	VMAC::operator T() const noexcept
+	{
+		static_assert(std::is_unsigned<T>::value, "");
+
+		T ret = 0;
+		for (int i = 0, iMax = static_cast<int>(std::min(sizeof(T), m_tag.size())); i < iMax; ++i)
+		{
+			ret <<= 8;
+			ret |= m_tag[i];
+		}
+		return ret;
+	}
+
+	inline VMAC& VMAC::addData(const Span<const Byte> inData)
+	{
+		const Byte *data = inData.data();
+		std::size_t size = inData.size();
+		m_sizeCounter += size;
+
+		if (m_bufferSize > 0)
+		{
+			const std::size_t len = std::min<std::size_t>((BLOCK_SIZE - m_bufferSize), size);  // try fill to BLOCK_SIZE bytes
+			for (std::size_t i = 0; i < len; ++i)
+				m_buffer[m_bufferSize + i] = data[i];
+			m_bufferSize += len;
+			data += len;
+			size -= len;
+
+			if (m_bufferSize < BLOCK_SIZE)  // still doesn't fill the buffer
+				return (*this);
+
+			addDataImpl(m_buffer, 1);
+			m_bufferSize = 0;
+		}
+
+		const std::size_t blocks = size / BLOCK_SIZE;
+		addDataImpl(data, blocks);
+		data += (blocks * BLOCK_SIZE);
+		size -= (blocks * BLOCK_SIZE);
+
+		for (std::size_t i = 0; i < size; ++i)
+			m_buffer[i] = data[i];
+		m_bufferSize = size;
+
+		return (*this);
+	}
+
+	inline VMAC& VMAC::addData(const void *ptr, const std::size_t length)
+	{
+		// Span::size_type = std::size_t
+		return addData({static_cast<const Byte*>(ptr), length});
+	}
+
+	template <std::size_t N>
+	VMAC& VMAC::addData(const Byte (&array)[N])
+	{
+		return addData({array, N});
+	}
+
+	template <typename T, std::size_t N>
+	VMAC& VMAC::addData(const T (&array)[N])
+	{
+		return addData({reinterpret_cast<const Byte*>(array), (sizeof(T) * N)});
+	}
+
+	template <typename T>
+	VMAC& VMAC::addData(const Span<T> inSpan)
+	{
+		return addData({reinterpret_cast<const Byte*>(inSpan.data()), inSpan.size_bytes()});
+	}
+
+	inline void VMAC::mul64(const uint64_t a, const uint64_t b, uint64_t &hi, uint64_t &lo)
+	{
+#if defined(__SIZEOF_INT128__)
+		const unsigned __int128 p = static_cast<unsigned __int128>(a) * b;
+		hi = static_cast<uint64_t>(p >> 64);
+		lo = static_cast<uint64_t>(p);
+#else
+		const uint64_t a0 = a & 0xFFFFFFFF, a1 = a >> 32;
+		const uint64_t b0 = b & 0xFFFFFFFF, b1 = b >> 32;
+		const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+		const uint64_t middle = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+		hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+		lo = (middle << 32) | (p00 & 0xFFFFFFFF);
+#endif
+	}
+
+	inline uint64_t VMAC::load64(const Byte *p)
+	{
+		uint64_t ret = 0;
+		for (int i = 7; i >= 0; --i)
+			ret = (ret << 8) | p[i];
+		return ret;
+	}
+
+	inline void VMAC::addDataImpl(const Byte *data, const std::size_t blocks)
+	{
+		for (std::size_t i = 0; i < blocks; ++i, data += BLOCK_SIZE)
+		{
+			// NH: sum of (m[2j] + k[2j]) * (m[2j + 1] + k[2j + 1]) mod 2^128, then mod 2^126
+			Uint128 nh = {0, 0};
+			for (int j = 0; j < (BLOCK_SIZE / 8); j += 2)
+			{
+				uint64_t hi = 0, lo = 0;
+				mul64((load64(data + (8 * j)) + m_nhKey[j]), (load64(data + (8 * (j + 1))) + m_nhKey[j + 1]), hi, lo);
+				nh.lo += lo;
+				nh.hi += hi + (nh.lo < lo);
+			}
+			nh.hi &= 0x3FFFFFFFFFFFFFFF;
+
+			polyStep(nh);
+		}
+	}
+
+	inline void VMAC::polyStep(const Uint128 &value)
+	{
+		// 256-bit product of m_poly (< 2^127) and the key (< 2^125)
+		uint64_t p[4] = {};
+		const uint64_t a[2] = {m_poly.lo, m_poly.hi};
+		const uint64_t b[2] = {m_polyKey.lo, m_polyKey.hi};
+		for (int i = 0; i < 2; ++i)
+		{
+			uint64_t carry = 0;
+			for (int j = 0; j < 2; ++j)
+			{
+				uint64_t hi = 0, lo = 0;
+				mul64(a[i], b[j], hi, lo);
+				lo += carry;
+				hi += (lo < carry);
+				p[i + j] += lo;
+				hi += (p[i + j] < lo);
+				carry = hi;
+			}
+			p[i + 2] += carry;
+		}
+
+		// 2^127 = 1: fold the bits above 127 onto the low 127 bits, then add the value
+		Uint128 sum = {(p[1] & M63), p[0]};
+		const Uint128 high = {((p[2] >> 63) | (p[3] << 1)), ((p[1] >> 63) | (p[2] << 1))};
+		sum.lo += high.lo;
+		sum.hi += high.hi + (sum.lo < high.lo);
+		sum.lo += value.lo;
+		sum.hi += value.hi + (sum.lo < value.lo);
+
+		while ((sum.hi >> 63) != 0)
+		{
+			sum.hi &= M63;
+			sum.lo += 1;
+			sum.hi += (sum.lo == 0);
+		}
+		if ((sum.hi == M63) && (sum.lo == UINT64_MAX))  // == 2^127 - 1
+			sum = {0, 0};
+
+		m_poly = sum;
+	}
+
+	inline uint64_t VMAC::l3Hash() const
+	{
+		// ((y >> 63) + k1) * ((y mod 2^63) + k2) mod 2^64 - 257
+		const auto addMod = [](uint64_t x, const uint64_t k) -> uint64_t
+		{
+			if (x >= P64)
+				x -= P64;
+			const uint64_t s = x + k;
+			return ((s < x) || (s >= P64)) ? (s - P64) : s;
+		};
+		const uint64_t a = addMod(((m_poly.hi << 1) | (m_poly.lo >> 63)), m_l3Key[0]);
+		const uint64_t b = addMod((m_poly.lo & M63), m_l3Key[1]);
+
+		// 2^64 = 257
+		uint64_t hi = 0, lo = 0;
+		mul64(a, b, hi, lo);
+		uint64_t hi2 = 0, lo2 = 0;
+		mul64(hi, 257, hi2, lo2);
+		uint64_t r = lo + lo2;
+		hi2 += (r < lo);
+		const uint64_t t = hi2 * 257;
+		const uint64_t r2 = r + t;
+		r = (r2 < r) ? (r2 + 257) : r2;
+		return (r >= P64) ? (r - P64) : r;
+	}
+}
+}
+
+	using VMAC_64 = Hash::VMAC_NS::VMAC;
+}
+
+namespace std
+{
+	template <>
+	struct hash<Chocobo1::VMAC_64>
+	{
+		size_t operator()(const Chocobo1::VMAC_64 &hash) const noexcept
+		{
+			return hash;
+		}
+	};
+}
+
+#endif  // CHOCOBO1_VMAC_H
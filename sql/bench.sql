@@ -0,0 +1,56 @@
+-- Rows per second on short inputs, run it in isql before and after a change:
+--   isql -q -i bench.sql employee
+
+SET TERM ^ ;
+
+EXECUTE BLOCK
+  RETURNS (method VARCHAR(16), input_ VARCHAR(8), rows_ INTEGER, ms BIGINT, rows_per_second BIGINT)
+AS
+  DECLARE rows_total INTEGER = 1000000;
+  DECLARE i INTEGER;
+  DECLARE hash_ SMALLINT;
+  DECLARE value_ VARCHAR(32) CHARACTER SET NONE = 'short input 0123';
+  DECLARE blob_ BLOB SUB_TYPE BINARY;
+  DECLARE key_ VARCHAR(128) CHARACTER SET NONE;
+  DECLARE started TIMESTAMP;
+BEGIN
+  rows_ = rows_total;
+  blob_ = value_;
+  FOR SELECT m.method, m.hash_
+    FROM (
+      SELECT 'Crc_32' AS method, hash.Crc_32() AS hash_ FROM rdb$database UNION ALL
+      SELECT 'Siphash', hash.Siphash() FROM rdb$database UNION ALL
+      SELECT 'Md5', hash.Md5() FROM rdb$database UNION ALL
+      SELECT 'Sha2_256', hash.Sha2_256() FROM rdb$database UNION ALL
+      SELECT 'Blake2s', hash.Blake2s() FROM rdb$database UNION ALL
+      SELECT 'Sha3_256', hash.Sha3_256() FROM rdb$database) m
+    INTO :method, :hash_
+  DO
+  BEGIN
+    input_ = 'VARCHAR';
+    i = 0;
+    started = CAST('NOW' AS TIMESTAMP);
+    WHILE (i < rows_total) DO
+    BEGIN
+      key_ = hash.key0s(hash_, value_);
+      i = i + 1;
+    END
+    ms = DATEDIFF(MILLISECOND FROM started TO CAST('NOW' AS TIMESTAMP));
+    rows_per_second = IIF(ms > 0, rows_total * 1000 / ms, NULL);
+    SUSPEND;
+
+    input_ = 'BLOB';
+    i = 0;
+    started = CAST('NOW' AS TIMESTAMP);
+    WHILE (i < rows_total) DO
+    BEGIN
+      key_ = hash.key0b(hash_, blob_);
+      i = i + 1;
+    END
+    ms = DATEDIFF(MILLISECOND FROM started TO CAST('NOW' AS TIMESTAMP));
+    rows_per_second = IIF(ms > 0, rows_total * 1000 / ms, NULL);
+    SUSPEND;
+  END
+END^
+
+SET TERM ; ^
@@ -17,14 +17,261 @@ BEGIN
 
   FUNCTION key2b(hash_ SMALLINT NOT NULL, custom VARCHAR(32765) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
     ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+  */
 
-  -- Cshake_..., Shake_..., Tuple_hash_...
-  FUNCTION key3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(32765) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+  -- Cshake_..., Shake_..., Kangaroo_twelve, Turboshake_..., Tuple_hash_... (digest in bytes)
+  FUNCTION key3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
     ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
 
-  FUNCTION key3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(32765) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+  FUNCTION key3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
     ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
-  */
+
+  -- same as key3..., raw output of any length streamed into BLOB
+  FUNCTION xof3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS BLOB SUB_TYPE BINARY;
+
+  FUNCTION xof3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS BLOB SUB_TYPE BINARY;
+
+  -- Tuple_hash_... over 2..4 elements; declare other arities or typed elements (numeric, date/time) the same way
+  FUNCTION tuple2s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION tuple3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE, value3_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION tuple4s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE, value3_ VARCHAR(8191) CHARACTER SET NONE, value4_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION tuple2b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION tuple3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY, value3_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION tuple4b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY, value3_ BLOB SUB_TYPE BINARY, value4_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  -- Kmac_..., Kmacxof_... (digest in bytes)
+  FUNCTION kmacs(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, custom VARCHAR(1024) CHARACTER SET NONE,
+    value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION kmacb(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, custom VARCHAR(1024) CHARACTER SET NONE,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  -- Merkle-Damgard and Sha3_... methods
+  FUNCTION hmacs(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  FUNCTION hmacb(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  -- key0...(hash_, prefix_ || value_), constant prefix_ (salt, namespace) is compressed once per statement
+  FUNCTION prefix0s(hash_ SMALLINT NOT NULL, prefix_ VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  FUNCTION prefix0b(hash_ SMALLINT NOT NULL, prefix_ VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  -- HMAC methods, length_ in bytes; ...s returns hex, ...r raw octets
+  FUNCTION pbkdf2s(hash_ SMALLINT NOT NULL, password VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    iterations INTEGER NOT NULL, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION pbkdf2r(hash_ SMALLINT NOT NULL, password VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    iterations INTEGER NOT NULL, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(512) CHARACTER SET OCTETS;
+
+  FUNCTION hkdfs(hash_ SMALLINT NOT NULL, ikm VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    info VARCHAR(1024) CHARACTER SET NONE, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE;
+
+  FUNCTION hkdfr(hash_ SMALLINT NOT NULL, ikm VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    info VARCHAR(1024) CHARACTER SET NONE, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(512) CHARACTER SET OCTETS;
+
+  -- Tiger_tree, every node of the hash tree: level_ 0 are the leaves, the last level is the root
+  PROCEDURE tree0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS (level_ INTEGER, node INTEGER, digest VARCHAR(48) CHARACTER SET NONE);
+
+  PROCEDURE tree0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS (level_ INTEGER, node INTEGER, digest VARCHAR(48) CHARACTER SET NONE);
+
+  -- Siphash (16 byte key), Poly1305 (32 byte key for one message only, NULL nonce), Vmac (nonce must not repeat under key_)
+  FUNCTION umacs(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, nonce VARCHAR(64) CHARACTER SET NONE,
+    value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(32) CHARACTER SET NONE;
+
+  FUNCTION umacb(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, nonce VARCHAR(64) CHARACTER SET NONE,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(32) CHARACTER SET NONE;
+
+  -- input_ encoding of value_ (NULL is Raw), output_ encoding of the digest (NULL is Hex), see Raw() .. Base32()
+  FUNCTION encoded2s(hash_ SMALLINT NOT NULL, input_ SMALLINT, output_ SMALLINT, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  FUNCTION encoded2b(hash_ SMALLINT NOT NULL, input_ SMALLINT, output_ SMALLINT, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE;
+
+  -- raw digest, length_ leading bytes (NULL is the whole digest); CHAR(N) CHARACTER SET OCTETS results work the same way
+  FUNCTION raw0s(hash_ SMALLINT NOT NULL, length_ INTEGER, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(64) CHARACTER SET OCTETS;
+
+  FUNCTION raw0b(hash_ SMALLINT NOT NULL, length_ INTEGER, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(64) CHARACTER SET OCTETS;
+
+  -- leading digest bytes as a signed integer (operator T of the hash classes), DETERMINISTIC for expression indexes
+  FUNCTION smallint0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS SMALLINT DETERMINISTIC;
+
+  FUNCTION smallint0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS SMALLINT DETERMINISTIC;
+
+  FUNCTION int0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS INTEGER DETERMINISTIC;
+
+  FUNCTION int0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS INTEGER DETERMINISTIC;
+
+  FUNCTION bigint0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS BIGINT DETERMINISTIC;
+
+  FUNCTION bigint0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS BIGINT DETERMINISTIC;
+
+  -- key0s/key0b bound to one method, no selector call and no method switch per row
+  FUNCTION blake1_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake1_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake2b_s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake2b_b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake2s_s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION blake2s_b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION crc_32s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION crc_32b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION fnv32_1as(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION fnv32_1ab(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION fnv64_1as(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION fnv64_1ab(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION has160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION has160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md2s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md2b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md4s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md4b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md5s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION md5b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_320s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION ripemd_320b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION siphashs(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION siphashb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha1s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha1b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha2_512_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sha3_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sm3s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION sm3b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_192s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger1_192b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_192s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger2_192b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION whirlpools(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION whirlpoolb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION kangaroo_twelves(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION kangaroo_twelveb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION turboshake_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION turboshake_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION turboshake_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION turboshake_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger_trees(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+  FUNCTION tiger_treeb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC;
+
+  -- digest of every row of sql_text, run in the caller's transaction
+  PROCEDURE row_digests(hash_ SMALLINT NOT NULL, sql_text VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS (row_number BIGINT, digest VARCHAR(128) CHARACTER SET NONE);
+
+  -- order independent table fingerprint, RDB$DB_KEY ranges on worker attachments (NULL workers = CPU count, never more than the free cores), a row per worker
+  PROCEDURE fingerprint(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL, workers INTEGER
+    ) RETURNS (range_ INTEGER, rows_ BIGINT, fingerprint VARCHAR(64) CHARACTER SET NONE, ms INTEGER);
+
+  -- memo of key digests for the attachment: entries most recent values up to max_length bytes, 0 entries is off
+  FUNCTION memoize(entries INTEGER NOT NULL, max_length INTEGER NOT NULL) RETURNS INTEGER;
+  PROCEDURE memo_stats
+    RETURNS (entries INTEGER, capacity INTEGER, max_length INTEGER, hits BIGINT, misses BIGINT);
+
+  -- digests of a BINARY BLOB of records in one call, lines TRUE is LF or CRLF terminated, FALSE 4 byte big-endian length prefixed
+  FUNCTION digests(hash_ SMALLINT NOT NULL, lines BOOLEAN NOT NULL, records BLOB SUB_TYPE BINARY)
+    RETURNS BLOB SUB_TYPE BINARY;
+
+  -- content-defined (FastCDC) chunks of a BLOB with their digests, NULL sizes are 2K/8K/64K
+  PROCEDURE chunks(hash_ SMALLINT NOT NULL, min_size INTEGER, avg_size INTEGER, max_size INTEGER,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS (offset_ BIGINT, length_ INTEGER, digest VARCHAR(128) CHARACTER SET NONE);
+
+  -- Merkle tree of a relation over its integer key, level_ 0 are the leaves
+  PROCEDURE merkle(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL,
+    key_column VARCHAR(63) CHARACTER SET NONE NOT NULL, fan_out INTEGER NOT NULL, leaf_rows INTEGER NOT NULL
+    ) RETURNS (level_ INTEGER, node INTEGER, low_key BIGINT, high_key BIGINT, rows_ BIGINT,
+    digest VARCHAR(128) CHARACTER SET NONE);
+
+  -- key ranges low_key <= key < high_key (NULL unbounded) that differ from the relation in another database
+  PROCEDURE merkle_diff(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL,
+    key_column VARCHAR(63) CHARACTER SET NONE NOT NULL, fan_out INTEGER NOT NULL, leaf_rows INTEGER NOT NULL,
+    database VARCHAR(255) CHARACTER SET NONE NOT NULL
+    ) RETURNS (low_key BIGINT, high_key BIGINT, local_rows BIGINT, remote_rows BIGINT);
+
+  -- what every selector can do, digest_size is NULL when the caller gives the length, threads: one large value on worker threads
+  PROCEDURE methods
+    RETURNS (hash_ SMALLINT, name VARCHAR(32) CHARACTER SET NONE, digest_size INTEGER, block_size INTEGER,
+    streaming BOOLEAN, hmac BOOLEAN, threads BOOLEAN);
+
+  -- forget the cached HASH$ exceptions after altering them
+  FUNCTION invalidate RETURNS INTEGER;
 
   FUNCTION Blake1_224 RETURNS SMALLINT;
   FUNCTION Blake1_256 RETURNS SMALLINT;
@@ -33,7 +280,8 @@ BEGIN
   FUNCTION Blake2 RETURNS SMALLINT;
   FUNCTION Blake2s RETURNS SMALLINT;
   FUNCTION Crc_32 RETURNS SMALLINT;
-  -- FUNCTION Cshake_128 RETURNS SMALLINT; FUNCTION Cshake_256 RETURNS SMALLINT; /* will in future */
+  FUNCTION Cshake_128 RETURNS SMALLINT;
+  FUNCTION Cshake_256 RETURNS SMALLINT;
   FUNCTION Fnv32_1a RETURNS SMALLINT;
   FUNCTION Fnv64_1a RETURNS SMALLINT;
   FUNCTION Has160 RETURNS SMALLINT;
@@ -56,7 +304,8 @@ BEGIN
   FUNCTION Sha3_256 RETURNS SMALLINT;
   FUNCTION Sha3_384 RETURNS SMALLINT;
   FUNCTION Sha3_512 RETURNS SMALLINT;
-  -- FUNCTION Shake_128 RETURNS SMALLINT; FUNCTION Shake_256 RETURNS SMALLINT; /* will in future */
+  FUNCTION Shake_128 RETURNS SMALLINT;
+  FUNCTION Shake_256 RETURNS SMALLINT;
   FUNCTION Sm3 RETURNS SMALLINT;
   FUNCTION Tiger1_128 RETURNS SMALLINT;
   FUNCTION Tiger1_160 RETURNS SMALLINT;
@@ -64,8 +313,25 @@ BEGIN
   FUNCTION Tiger2_128 RETURNS SMALLINT;
   FUNCTION Tiger2_160 RETURNS SMALLINT;
   FUNCTION Tiger2_192 RETURNS SMALLINT;
-  -- FUNCTION Tuple_hash_128 RETURNS SMALLINT; FUNCTION Tuple_hash_256 RETURNS SMALLINT; /* will in future */
+  FUNCTION Tuple_hash_128 RETURNS SMALLINT;
+  FUNCTION Tuple_hash_256 RETURNS SMALLINT;
   FUNCTION Whirlpool RETURNS SMALLINT;
+  FUNCTION Kangaroo_twelve RETURNS SMALLINT;
+  FUNCTION Turboshake_128 RETURNS SMALLINT;
+  FUNCTION Turboshake_256 RETURNS SMALLINT;
+  FUNCTION Kmac_128 RETURNS SMALLINT;
+  FUNCTION Kmac_256 RETURNS SMALLINT;
+  FUNCTION Kmacxof_128 RETURNS SMALLINT;
+  FUNCTION Kmacxof_256 RETURNS SMALLINT;
+  FUNCTION Tiger_tree RETURNS SMALLINT;
+  FUNCTION Poly1305 RETURNS SMALLINT;
+  FUNCTION Vmac RETURNS SMALLINT;
+
+  FUNCTION Raw RETURNS SMALLINT;
+  FUNCTION Hex RETURNS SMALLINT;
+  FUNCTION Base64 RETURNS SMALLINT;
+  FUNCTION Base64url RETURNS SMALLINT;
+  FUNCTION Base32 RETURNS SMALLINT;
 
 END^
 
@@ -83,6 +349,409 @@ BEGIN
     EXTERNAL NAME 'hash!key'
     ENGINE UDR;
 
+  FUNCTION key3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!xof'
+    ENGINE UDR;
+
+  FUNCTION key3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!xof'
+    ENGINE UDR;
+
+  FUNCTION xof3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS BLOB SUB_TYPE BINARY
+    EXTERNAL NAME 'hash!xof'
+    ENGINE UDR;
+
+  FUNCTION xof3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS BLOB SUB_TYPE BINARY
+    EXTERNAL NAME 'hash!xof'
+    ENGINE UDR;
+
+  FUNCTION tuple2s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION tuple3s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE, value3_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION tuple4s(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ VARCHAR(8191) CHARACTER SET NONE, value2_ VARCHAR(8191) CHARACTER SET NONE, value3_ VARCHAR(8191) CHARACTER SET NONE, value4_ VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION tuple2b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION tuple3b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY, value3_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION tuple4b(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, custom VARCHAR(1024) CHARACTER SET NONE,
+    value1_ BLOB SUB_TYPE BINARY, value2_ BLOB SUB_TYPE BINARY, value3_ BLOB SUB_TYPE BINARY, value4_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!tuple'
+    ENGINE UDR;
+
+  FUNCTION kmacs(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, custom VARCHAR(1024) CHARACTER SET NONE,
+    value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!kmac'
+    ENGINE UDR;
+
+  FUNCTION kmacb(hash_ SMALLINT NOT NULL, digest INTEGER NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, custom VARCHAR(1024) CHARACTER SET NONE,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!kmac'
+    ENGINE UDR;
+
+  FUNCTION hmacs(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!hmac'
+    ENGINE UDR;
+
+  FUNCTION hmacb(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!hmac'
+    ENGINE UDR;
+
+  FUNCTION prefix0s(hash_ SMALLINT NOT NULL, prefix_ VARCHAR(1024) CHARACTER SET NONE, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!prefix'
+    ENGINE UDR;
+
+  FUNCTION prefix0b(hash_ SMALLINT NOT NULL, prefix_ VARCHAR(1024) CHARACTER SET NONE, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!prefix'
+    ENGINE UDR;
+
+  FUNCTION pbkdf2s(hash_ SMALLINT NOT NULL, password VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    iterations INTEGER NOT NULL, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!pbkdf2'
+    ENGINE UDR;
+
+  FUNCTION pbkdf2r(hash_ SMALLINT NOT NULL, password VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    iterations INTEGER NOT NULL, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(512) CHARACTER SET OCTETS
+    EXTERNAL NAME 'hash!pbkdf2'
+    ENGINE UDR;
+
+  FUNCTION hkdfs(hash_ SMALLINT NOT NULL, ikm VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    info VARCHAR(1024) CHARACTER SET NONE, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(1024) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!hkdf'
+    ENGINE UDR;
+
+  FUNCTION hkdfr(hash_ SMALLINT NOT NULL, ikm VARCHAR(1024) CHARACTER SET NONE, salt VARCHAR(1024) CHARACTER SET NONE,
+    info VARCHAR(1024) CHARACTER SET NONE, length_ INTEGER NOT NULL
+    ) RETURNS VARCHAR(512) CHARACTER SET OCTETS
+    EXTERNAL NAME 'hash!hkdf'
+    ENGINE UDR;
+
+  PROCEDURE tree0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS (level_ INTEGER, node INTEGER, digest VARCHAR(48) CHARACTER SET NONE)
+    EXTERNAL NAME 'hash!tree'
+    ENGINE UDR;
+
+  PROCEDURE tree0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS (level_ INTEGER, node INTEGER, digest VARCHAR(48) CHARACTER SET NONE)
+    EXTERNAL NAME 'hash!tree'
+    ENGINE UDR;
+
+  FUNCTION umacs(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, nonce VARCHAR(64) CHARACTER SET NONE,
+    value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(32) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!umac'
+    ENGINE UDR;
+
+  FUNCTION umacb(hash_ SMALLINT NOT NULL, key_ VARCHAR(1024) CHARACTER SET NONE, nonce VARCHAR(64) CHARACTER SET NONE,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(32) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!umac'
+    ENGINE UDR;
+
+  FUNCTION encoded2s(hash_ SMALLINT NOT NULL, input_ SMALLINT, output_ SMALLINT, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!encoded'
+    ENGINE UDR;
+
+  FUNCTION encoded2b(hash_ SMALLINT NOT NULL, input_ SMALLINT, output_ SMALLINT, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(128) CHARACTER SET NONE
+    EXTERNAL NAME 'hash!encoded'
+    ENGINE UDR;
+
+  FUNCTION raw0s(hash_ SMALLINT NOT NULL, length_ INTEGER, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS VARCHAR(64) CHARACTER SET OCTETS
+    EXTERNAL NAME 'hash!raw'
+    ENGINE UDR;
+
+  FUNCTION raw0b(hash_ SMALLINT NOT NULL, length_ INTEGER, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS VARCHAR(64) CHARACTER SET OCTETS
+    EXTERNAL NAME 'hash!raw'
+    ENGINE UDR;
+
+  FUNCTION smallint0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS SMALLINT DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION smallint0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS SMALLINT DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION int0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS INTEGER DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION int0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS INTEGER DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION bigint0s(hash_ SMALLINT NOT NULL, value_ VARCHAR(32765) CHARACTER SET NONE
+    ) RETURNS BIGINT DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION bigint0b(hash_ SMALLINT NOT NULL, value_ BLOB SUB_TYPE BINARY
+    ) RETURNS BIGINT DETERMINISTIC
+    EXTERNAL NAME 'hash!integer'
+    ENGINE UDR;
+
+  FUNCTION blake1_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_224' ENGINE UDR;
+  FUNCTION blake1_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_224' ENGINE UDR;
+  FUNCTION blake1_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_256' ENGINE UDR;
+  FUNCTION blake1_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_256' ENGINE UDR;
+  FUNCTION blake1_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_384' ENGINE UDR;
+  FUNCTION blake1_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_384' ENGINE UDR;
+  FUNCTION blake1_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_512' ENGINE UDR;
+  FUNCTION blake1_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake1_512' ENGINE UDR;
+  FUNCTION blake2b_s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake2' ENGINE UDR;
+  FUNCTION blake2b_b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake2' ENGINE UDR;
+  FUNCTION blake2s_s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake2s' ENGINE UDR;
+  FUNCTION blake2s_b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!blake2s' ENGINE UDR;
+  FUNCTION crc_32s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!crc_32' ENGINE UDR;
+  FUNCTION crc_32b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!crc_32' ENGINE UDR;
+  FUNCTION fnv32_1as(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!fnv32_1a' ENGINE UDR;
+  FUNCTION fnv32_1ab(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!fnv32_1a' ENGINE UDR;
+  FUNCTION fnv64_1as(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!fnv64_1a' ENGINE UDR;
+  FUNCTION fnv64_1ab(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!fnv64_1a' ENGINE UDR;
+  FUNCTION has160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!has160' ENGINE UDR;
+  FUNCTION has160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!has160' ENGINE UDR;
+  FUNCTION md2s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md2' ENGINE UDR;
+  FUNCTION md2b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md2' ENGINE UDR;
+  FUNCTION md4s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md4' ENGINE UDR;
+  FUNCTION md4b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md4' ENGINE UDR;
+  FUNCTION md5s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md5' ENGINE UDR;
+  FUNCTION md5b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!md5' ENGINE UDR;
+  FUNCTION ripemd_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_128' ENGINE UDR;
+  FUNCTION ripemd_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_128' ENGINE UDR;
+  FUNCTION ripemd_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_160' ENGINE UDR;
+  FUNCTION ripemd_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_160' ENGINE UDR;
+  FUNCTION ripemd_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_256' ENGINE UDR;
+  FUNCTION ripemd_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_256' ENGINE UDR;
+  FUNCTION ripemd_320s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_320' ENGINE UDR;
+  FUNCTION ripemd_320b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!ripemd_320' ENGINE UDR;
+  FUNCTION siphashs(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!siphash' ENGINE UDR;
+  FUNCTION siphashb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!siphash' ENGINE UDR;
+  FUNCTION sha1s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha1' ENGINE UDR;
+  FUNCTION sha1b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha1' ENGINE UDR;
+  FUNCTION sha2_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_224' ENGINE UDR;
+  FUNCTION sha2_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_224' ENGINE UDR;
+  FUNCTION sha2_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_256' ENGINE UDR;
+  FUNCTION sha2_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_256' ENGINE UDR;
+  FUNCTION sha2_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_384' ENGINE UDR;
+  FUNCTION sha2_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_384' ENGINE UDR;
+  FUNCTION sha2_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512' ENGINE UDR;
+  FUNCTION sha2_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512' ENGINE UDR;
+  FUNCTION sha2_512_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512_224' ENGINE UDR;
+  FUNCTION sha2_512_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512_224' ENGINE UDR;
+  FUNCTION sha2_512_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512_256' ENGINE UDR;
+  FUNCTION sha2_512_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha2_512_256' ENGINE UDR;
+  FUNCTION sha3_224s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_224' ENGINE UDR;
+  FUNCTION sha3_224b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_224' ENGINE UDR;
+  FUNCTION sha3_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_256' ENGINE UDR;
+  FUNCTION sha3_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_256' ENGINE UDR;
+  FUNCTION sha3_384s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_384' ENGINE UDR;
+  FUNCTION sha3_384b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_384' ENGINE UDR;
+  FUNCTION sha3_512s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_512' ENGINE UDR;
+  FUNCTION sha3_512b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sha3_512' ENGINE UDR;
+  FUNCTION sm3s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sm3' ENGINE UDR;
+  FUNCTION sm3b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!sm3' ENGINE UDR;
+  FUNCTION tiger1_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_128' ENGINE UDR;
+  FUNCTION tiger1_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_128' ENGINE UDR;
+  FUNCTION tiger1_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_160' ENGINE UDR;
+  FUNCTION tiger1_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_160' ENGINE UDR;
+  FUNCTION tiger1_192s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_192' ENGINE UDR;
+  FUNCTION tiger1_192b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger1_192' ENGINE UDR;
+  FUNCTION tiger2_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_128' ENGINE UDR;
+  FUNCTION tiger2_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_128' ENGINE UDR;
+  FUNCTION tiger2_160s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_160' ENGINE UDR;
+  FUNCTION tiger2_160b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_160' ENGINE UDR;
+  FUNCTION tiger2_192s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_192' ENGINE UDR;
+  FUNCTION tiger2_192b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger2_192' ENGINE UDR;
+  FUNCTION whirlpools(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!whirlpool' ENGINE UDR;
+  FUNCTION whirlpoolb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!whirlpool' ENGINE UDR;
+  FUNCTION kangaroo_twelves(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!kangaroo_twelve' ENGINE UDR;
+  FUNCTION kangaroo_twelveb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!kangaroo_twelve' ENGINE UDR;
+  FUNCTION turboshake_128s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!turboshake_128' ENGINE UDR;
+  FUNCTION turboshake_128b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!turboshake_128' ENGINE UDR;
+  FUNCTION turboshake_256s(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!turboshake_256' ENGINE UDR;
+  FUNCTION turboshake_256b(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!turboshake_256' ENGINE UDR;
+  FUNCTION tiger_trees(value_ VARCHAR(32765) CHARACTER SET NONE) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger_tree' ENGINE UDR;
+  FUNCTION tiger_treeb(value_ BLOB SUB_TYPE BINARY) RETURNS VARCHAR(128) CHARACTER SET NONE DETERMINISTIC
+    EXTERNAL NAME 'hash!key!tiger_tree' ENGINE UDR;
+
+  PROCEDURE row_digests(hash_ SMALLINT NOT NULL, sql_text VARCHAR(8191) CHARACTER SET NONE
+    ) RETURNS (row_number BIGINT, digest VARCHAR(128) CHARACTER SET NONE)
+    EXTERNAL NAME 'hash!row_digests'
+    ENGINE UDR;
+
+  PROCEDURE fingerprint(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL, workers INTEGER
+    ) RETURNS (range_ INTEGER, rows_ BIGINT, fingerprint VARCHAR(64) CHARACTER SET NONE, ms INTEGER)
+    EXTERNAL NAME 'hash!fingerprint'
+    ENGINE UDR;
+
+  FUNCTION memoize(entries INTEGER NOT NULL, max_length INTEGER NOT NULL) RETURNS INTEGER
+    EXTERNAL NAME 'hash!memoize'
+    ENGINE UDR;
+
+  PROCEDURE memo_stats
+    RETURNS (entries INTEGER, capacity INTEGER, max_length INTEGER, hits BIGINT, misses BIGINT)
+    EXTERNAL NAME 'hash!memo_stats'
+    ENGINE UDR;
+
+  FUNCTION digests(hash_ SMALLINT NOT NULL, lines BOOLEAN NOT NULL, records BLOB SUB_TYPE BINARY)
+    RETURNS BLOB SUB_TYPE BINARY
+    EXTERNAL NAME 'hash!digests'
+    ENGINE UDR;
+
+  PROCEDURE chunks(hash_ SMALLINT NOT NULL, min_size INTEGER, avg_size INTEGER, max_size INTEGER,
+    value_ BLOB SUB_TYPE BINARY
+    ) RETURNS (offset_ BIGINT, length_ INTEGER, digest VARCHAR(128) CHARACTER SET NONE)
+    EXTERNAL NAME 'hash!chunks'
+    ENGINE UDR;
+
+  PROCEDURE merkle(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL,
+    key_column VARCHAR(63) CHARACTER SET NONE NOT NULL, fan_out INTEGER NOT NULL, leaf_rows INTEGER NOT NULL
+    ) RETURNS (level_ INTEGER, node INTEGER, low_key BIGINT, high_key BIGINT, rows_ BIGINT,
+    digest VARCHAR(128) CHARACTER SET NONE)
+    EXTERNAL NAME 'hash!merkle'
+    ENGINE UDR;
+
+  PROCEDURE merkle_diff(hash_ SMALLINT NOT NULL, relation VARCHAR(63) CHARACTER SET NONE NOT NULL,
+    key_column VARCHAR(63) CHARACTER SET NONE NOT NULL, fan_out INTEGER NOT NULL, leaf_rows INTEGER NOT NULL,
+    database VARCHAR(255) CHARACTER SET NONE NOT NULL
+    ) RETURNS (low_key BIGINT, high_key BIGINT, local_rows BIGINT, remote_rows BIGINT)
+    EXTERNAL NAME 'hash!merkle_diff'
+    ENGINE UDR;
+
+  PROCEDURE methods
+    RETURNS (hash_ SMALLINT, name VARCHAR(32) CHARACTER SET NONE, digest_size INTEGER, block_size INTEGER,
+    streaming BOOLEAN, hmac BOOLEAN, threads BOOLEAN)
+    EXTERNAL NAME 'hash!methods'
+    ENGINE UDR;
+
+  FUNCTION invalidate RETURNS INTEGER
+    EXTERNAL NAME 'hash!invalidate'
+    ENGINE UDR;
+
   FUNCTION Blake1_224 RETURNS SMALLINT AS BEGIN RETURN 1; END
   FUNCTION Blake1_256 RETURNS SMALLINT AS BEGIN RETURN 2; END
   FUNCTION Blake1_384 RETURNS SMALLINT AS BEGIN RETURN 3; END
@@ -126,6 +795,22 @@ BEGIN
   FUNCTION Tuple_hash_128 RETURNS SMALLINT AS BEGIN RETURN 41; END
   FUNCTION Tuple_hash_256 RETURNS SMALLINT AS BEGIN RETURN 42; END
   FUNCTION Whirlpool RETURNS SMALLINT AS BEGIN RETURN 43; END
+  FUNCTION Kangaroo_twelve RETURNS SMALLINT AS BEGIN RETURN 44; END
+  FUNCTION Turboshake_128 RETURNS SMALLINT AS BEGIN RETURN 45; END
+  FUNCTION Turboshake_256 RETURNS SMALLINT AS BEGIN RETURN 46; END
+  FUNCTION Kmac_128 RETURNS SMALLINT AS BEGIN RETURN 47; END
+  FUNCTION Kmac_256 RETURNS SMALLINT AS BEGIN RETURN 48; END
+  FUNCTION Kmacxof_128 RETURNS SMALLINT AS BEGIN RETURN 49; END
+  FUNCTION Kmacxof_256 RETURNS SMALLINT AS BEGIN RETURN 50; END
+  FUNCTION Tiger_tree RETURNS SMALLINT AS BEGIN RETURN 51; END
+  FUNCTION Poly1305 RETURNS SMALLINT AS BEGIN RETURN 52; END
+  FUNCTION Vmac RETURNS SMALLINT AS BEGIN RETURN 53; END
+
+  FUNCTION Raw RETURNS SMALLINT AS BEGIN RETURN 0; END
+  FUNCTION Hex RETURNS SMALLINT AS BEGIN RETURN 1; END
+  FUNCTION Base64 RETURNS SMALLINT AS BEGIN RETURN 2; END
+  FUNCTION Base64url RETURNS SMALLINT AS BEGIN RETURN 3; END
+  FUNCTION Base32 RETURNS SMALLINT AS BEGIN RETURN 4; END
 
 END^
 
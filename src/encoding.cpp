@@ -0,0 +1,476 @@
+ /*
+  *  The contents of this file are subject to the Initial
+  *  Developer's Public License Version 1.0 (the "License");
+  *  you may not use this file except in compliance with the
+  *  License. You may obtain a copy of the License at
+  *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+  *
+  *  Software distributed under the License is distributed AS IS,
+  *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+  *  See the License for the specific language governing rights
+  *  and limitations under the License.
+  *
+  *  The Original Code was created by Maxim Filatov.
+  *
+  *  Copyright (c) 2022 Maxim Filatov <2chemist@mail.ru>
+  *  and all contributors signed below.
+  *
+  *  All Rights Reserved.
+  *  Contributor(s): ______________________________________.
+  */
+
+#include "encoding.h"
+
+#include <stdexcept>
+#include <ctype.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define HASHUDR_X86
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define HASHUDR_TARGET(isa) // MSVC compiles every intrinsic, the dispatch below guards them
+#else
+#define HASHUDR_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace hashudr
+{
+
+namespace
+{
+
+const char hex_digits[] = "0123456789abcdef";
+const char base64_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+const char base64url_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+const char base32_digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+
+const signed char PAD = -2;
+const signed char BAD = -1;
+
+struct decode_tables
+{
+	signed char hex[256];
+	signed char base64[256];
+	signed char base64url[256];
+	signed char base32[256];
+
+	decode_tables()
+	{
+		memset(hex, BAD, sizeof(hex));
+		memset(base64, BAD, sizeof(base64));
+		memset(base64url, BAD, sizeof(base64url));
+		memset(base32, BAD, sizeof(base32));
+
+		for (int i = 0; i < 16; ++i)
+		{
+			hex[static_cast<unsigned char>(hex_digits[i])] = static_cast<signed char>(i);
+			hex[static_cast<unsigned char>(toupper(hex_digits[i]))] = static_cast<signed char>(i);
+		}
+		for (int i = 0; i < 64; ++i)
+		{
+			base64[static_cast<unsigned char>(base64_digits[i])] = static_cast<signed char>(i);
+			base64url[static_cast<unsigned char>(base64url_digits[i])] = static_cast<signed char>(i);
+		}
+		for (int i = 0; i < 32; ++i)
+		{
+			base32[static_cast<unsigned char>(base32_digits[i])] = static_cast<signed char>(i);
+			base32[static_cast<unsigned char>(tolower(base32_digits[i]))] = static_cast<signed char>(i);
+		}
+		base64['='] = base64url['='] = base32['='] = PAD;
+	}
+};
+
+const decode_tables tables;
+
+//-----------------------------------------------------------------------------
+// Hex
+//
+
+void hex_encode_scalar(const unsigned char* data, std::size_t length, char* out)
+{
+	for (; length > 0; --length, ++data)
+	{
+		*out++ = hex_digits[*data >> 4];
+		*out++ = hex_digits[*data & 0x0F];
+	}
+}
+
+bool hex_decode_scalar(const unsigned char* data, std::size_t length, unsigned char* out) // length is even
+{
+	int bad = 0;
+	for (; length > 0; length -= 2, data += 2)
+	{
+		const int hi = tables.hex[data[0]];
+		const int lo = tables.hex[data[1]];
+		bad |= hi | lo;
+		*out++ = static_cast<unsigned char>(((hi & 0x0F) << 4) | (lo & 0x0F));
+	}
+	return bad >= 0;
+}
+
+#ifdef HASHUDR_X86
+
+HASHUDR_TARGET("ssse3")
+void hex_encode_ssse3(const unsigned char* data, std::size_t length, char* out)
+{
+	const __m128i digits = _mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_digits));
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+
+	for (; length >= 16; length -= 16, data += 16, out += 32)
+	{
+		const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+		const __m128i hi = _mm_shuffle_epi8(digits, _mm_and_si128(_mm_srli_epi16(v, 4), nibble));
+		const __m128i lo = _mm_shuffle_epi8(digits, _mm_and_si128(v, nibble));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+	hex_encode_scalar(data, length, out);
+}
+
+HASHUDR_TARGET("avx2")
+void hex_encode_avx2(const unsigned char* data, std::size_t length, char* out)
+{
+	const __m256i digits = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(hex_digits)));
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+	for (; length >= 32; length -= 32, data += 32, out += 64)
+	{
+		const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		const __m256i hi = _mm256_shuffle_epi8(digits, _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble));
+		const __m256i lo = _mm256_shuffle_epi8(digits, _mm256_and_si256(v, nibble));
+		const __m256i first = _mm256_unpacklo_epi8(hi, lo); // bytes 0..7 | 16..23
+		const __m256i second = _mm256_unpackhi_epi8(hi, lo); // bytes 8..15 | 24..31
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(first, second, 0x20));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(first, second, 0x31));
+	}
+	hex_encode_ssse3(data, length, out);
+}
+
+HASHUDR_TARGET("ssse3")
+inline __m128i hex_values_ssse3(const __m128i c, __m128i& valid) // 16 chars to nibbles, valid lanes are 0xFF
+{
+	const __m128i lower = _mm_or_si128(c, _mm_set1_epi8(0x20));
+	const __m128i digit = _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8('0' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('9' + 1), c));
+	const __m128i alpha = _mm_and_si128(_mm_cmpgt_epi8(lower, _mm_set1_epi8('a' - 1)), _mm_cmpgt_epi8(_mm_set1_epi8('f' + 1), lower));
+	valid = _mm_and_si128(valid, _mm_or_si128(digit, alpha));
+	return _mm_or_si128(
+		_mm_and_si128(digit, _mm_sub_epi8(c, _mm_set1_epi8('0'))),
+		_mm_and_si128(alpha, _mm_sub_epi8(lower, _mm_set1_epi8('a' - 10))));
+}
+
+HASHUDR_TARGET("ssse3")
+bool hex_decode_ssse3(const unsigned char* data, std::size_t length, unsigned char* out)
+{
+	const __m128i weights = _mm_set1_epi16(0x0110); // hi * 16 + lo
+	__m128i valid = _mm_set1_epi8(-1);
+
+	for (; length >= 32; length -= 32, data += 32, out += 16)
+	{
+		const __m128i a = hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), valid);
+		const __m128i b = hex_values_ssse3(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + 16)), valid);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out),
+			_mm_packus_epi16(_mm_maddubs_epi16(a, weights), _mm_maddubs_epi16(b, weights)));
+	}
+	return (_mm_movemask_epi8(valid) == 0xFFFF) & hex_decode_scalar(data, length, out);
+}
+
+HASHUDR_TARGET("avx2")
+inline __m256i hex_values_avx2(const __m256i c, __m256i& valid)
+{
+	const __m256i lower = _mm256_or_si256(c, _mm256_set1_epi8(0x20));
+	const __m256i digit = _mm256_and_si256(_mm256_cmpgt_epi8(c, _mm256_set1_epi8('0' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), c));
+	const __m256i alpha = _mm256_and_si256(_mm256_cmpgt_epi8(lower, _mm256_set1_epi8('a' - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8('f' + 1), lower));
+	valid = _mm256_and_si256(valid, _mm256_or_si256(digit, alpha));
+	return _mm256_or_si256(
+		_mm256_and_si256(digit, _mm256_sub_epi8(c, _mm256_set1_epi8('0'))),
+		_mm256_and_si256(alpha, _mm256_sub_epi8(lower, _mm256_set1_epi8('a' - 10))));
+}
+
+HASHUDR_TARGET("avx2")
+bool hex_decode_avx2(const unsigned char* data, std::size_t length, unsigned char* out)
+{
+	const __m256i weights = _mm256_set1_epi16(0x0110);
+	__m256i valid = _mm256_set1_epi8(-1);
+
+	for (; length >= 64; length -= 64, data += 64, out += 32)
+	{
+		const __m256i a = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data)), valid);
+		const __m256i b = hex_values_avx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 32)), valid);
+		const __m256i packed = _mm256_packus_epi16(_mm256_maddubs_epi16(a, weights), _mm256_maddubs_epi16(b, weights));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute4x64_epi64(packed, 0xD8)); // lanes back in order
+	}
+	return (_mm256_movemask_epi8(valid) == -1) & hex_decode_ssse3(data, length, out);
+}
+
+#endif // HASHUDR_X86
+
+struct hex_kernels // picked once, by the CPU the library is loaded on
+{
+	void (*encode)(const unsigned char*, std::size_t, char*) = hex_encode_scalar;
+	bool (*decode)(const unsigned char*, std::size_t, unsigned char*) = hex_decode_scalar;
+
+	hex_kernels()
+	{
+#ifdef HASHUDR_X86
+		bool ssse3 = false, avx2 = false;
+#if defined(_MSC_VER)
+		int info[4];
+		__cpuid(info, 0);
+		const int max_leaf = info[0];
+		__cpuid(info, 1);
+		ssse3 = (info[2] & (1 << 9)) != 0;
+		const bool os_avx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 6) == 6);
+		if (max_leaf >= 7 && os_avx)
+		{
+			__cpuidex(info, 7, 0);
+			avx2 = (info[1] & (1 << 5)) != 0;
+		}
+#else
+		__builtin_cpu_init();
+		ssse3 = __builtin_cpu_supports("ssse3");
+		avx2 = __builtin_cpu_supports("avx2");
+#endif
+		if (avx2)
+		{
+			encode = hex_encode_avx2;
+			decode = hex_decode_avx2;
+		}
+		else if (ssse3)
+		{
+			encode = hex_encode_ssse3;
+			decode = hex_decode_ssse3;
+		}
+#endif
+	}
+};
+
+const hex_kernels hex;
+
+//-----------------------------------------------------------------------------
+// Base64, base32
+//
+
+void base64_encode(const char* digits, const bool pad, const unsigned char* data, std::size_t length, char* out)
+{
+	for (; length >= 3; length -= 3, data += 3)
+	{
+		const unsigned v = (data[0] << 16) | (data[1] << 8) | data[2];
+		*out++ = digits[v >> 18];
+		*out++ = digits[(v >> 12) & 0x3F];
+		*out++ = digits[(v >> 6) & 0x3F];
+		*out++ = digits[v & 0x3F];
+	}
+	if (length > 0)
+	{
+		const unsigned v = (data[0] << 16) | (length > 1 ? data[1] << 8 : 0);
+		*out++ = digits[v >> 18];
+		*out++ = digits[(v >> 12) & 0x3F];
+		if (length > 1)
+			*out++ = digits[(v >> 6) & 0x3F];
+		else if (pad)
+			*out++ = '=';
+		if (pad)
+			*out++ = '=';
+	}
+}
+
+void base32_encode(const unsigned char* data, std::size_t length, char* out)
+{
+	static const unsigned chars[] = { 0, 2, 4, 5, 7 }; // significant chars of a group by its bytes
+
+	for (; length > 0; data += 5)
+	{
+		const std::size_t n = length < 5 ? length : 5;
+		unsigned long long v = 0;
+		for (std::size_t i = 0; i < 5; ++i)
+			v = (v << 8) | (i < n ? data[i] : 0);
+		for (unsigned i = 0; i < 8; ++i)
+			*out++ = (n == 5 || i < chars[n]) ? base32_digits[(v >> (35 - 5 * i)) & 0x1F] : '=';
+		length -= n;
+	}
+}
+
+} // namespace
+
+//-----------------------------------------------------------------------------
+// encode
+//
+
+std::size_t encoded_length(const ENCODING encoding, const std::size_t length)
+{
+	switch (encoding)
+	{
+		case ENCODING::Raw:			return length;
+		case ENCODING::Hex:			return length * 2;
+		case ENCODING::Base64:		return (length + 2) / 3 * 4;
+		case ENCODING::Base64url:	return (length * 4 + 2) / 3; // unpadded
+		case ENCODING::Base32:		return (length + 4) / 5 * 8;
+
+		default:
+			throw std::runtime_error("Invalid ENCODING.");
+	}
+}
+
+void encode(const ENCODING encoding, const unsigned char* data, const std::size_t length, char* out)
+{
+	switch (encoding)
+	{
+		case ENCODING::Raw:			memcpy(out, data, length); break;
+		case ENCODING::Hex:			hex.encode(data, length, out); break;
+		case ENCODING::Base64:		base64_encode(base64_digits, true, data, length, out); break;
+		case ENCODING::Base64url:	base64_encode(base64url_digits, false, data, length, out); break;
+		case ENCODING::Base32:		base32_encode(data, length, out); break;
+
+		default:
+			throw std::runtime_error("Invalid ENCODING.");
+	}
+}
+
+std::string encode(const ENCODING encoding, const unsigned char* data, const std::size_t length)
+{
+	std::string ret(encoded_length(encoding, length), '\0');
+	encode(encoding, data, length, &ret[0]);
+	return ret;
+}
+
+//-----------------------------------------------------------------------------
+// decoder
+//
+
+decoder::decoder(const ENCODING encoding)
+	: encoding(encoding)
+	, group(encoding == ENCODING::Raw ? 1 : encoding == ENCODING::Hex ? 2 : encoding == ENCODING::Base32 ? 8 : 4)
+{
+	if (encoding < ENCODING::Raw || encoding > ENCODING::Base32)
+		throw std::runtime_error("Invalid ENCODING.");
+}
+
+std::size_t decoder::decode_groups(const unsigned char* data, const std::size_t length, unsigned char* out)
+{
+	if (padded)
+		throw std::runtime_error("Encoded input continues after padding.");
+
+	switch (encoding)
+	{
+		case ENCODING::Hex:
+		{
+			if (!hex.decode(data, length, out))
+				throw std::runtime_error("Invalid hex input.");
+			return length / 2;
+		}
+		case ENCODING::Base64:
+		case ENCODING::Base64url:
+		{
+			const signed char* table = encoding == ENCODING::Base64 ? tables.base64 : tables.base64url;
+			unsigned char* begin = out;
+			for (std::size_t i = 0; i < length; i += 4)
+			{
+				const int a = table[data[i]], b = table[data[i + 1]], c = table[data[i + 2]], d = table[data[i + 3]];
+				if ((a | b | c | d) >= 0)
+				{
+					const unsigned v = (a << 18) | (b << 12) | (c << 6) | d;
+					*out++ = static_cast<unsigned char>(v >> 16);
+					*out++ = static_cast<unsigned char>(v >> 8);
+					*out++ = static_cast<unsigned char>(v);
+					continue;
+				}
+				// "xx==" or "xxx=", only as the last group
+				const bool last = (i + 4 == length);
+				if (!last || a < 0 || b < 0 || d != PAD || (c < 0 && c != PAD))
+					throw std::runtime_error("Invalid base64 input.");
+				const unsigned v = (a << 18) | (b << 12) | (c >= 0 ? c << 6 : 0);
+				*out++ = static_cast<unsigned char>(v >> 16);
+				if (c >= 0)
+					*out++ = static_cast<unsigned char>(v >> 8);
+				padded = true;
+			}
+			return static_cast<std::size_t>(out - begin);
+		}
+		case ENCODING::Base32:
+		{
+			static const int bytes_by_chars[] = { 0, 0, 1, 0, 2, 3, 0, 4, 5 }; // 0 marks an invalid padding
+			unsigned char* begin = out;
+			for (std::size_t i = 0; i < length; i += 8)
+			{
+				unsigned long long v = 0;
+				unsigned chars = 0;
+				bool bad = false;
+				for (unsigned j = 0; j < 8; ++j)
+				{
+					const int c = tables.base32[data[i + j]];
+					if (c == PAD)
+						break;
+					bad |= (c < 0);
+					v |= static_cast<unsigned long long>(c & 0x1F) << (35 - 5 * j);
+					++chars;
+				}
+				for (unsigned j = chars; j < 8; ++j)
+					bad |= (tables.base32[data[i + j]] != PAD);
+				const int bytes = bytes_by_chars[chars];
+				if (bad || bytes == 0 || (chars < 8 && i + 8 != length))
+					throw std::runtime_error("Invalid base32 input.");
+				for (int j = 0; j < bytes; ++j)
+					*out++ = static_cast<unsigned char>(v >> (32 - 8 * j));
+				padded = (chars < 8);
+			}
+			return static_cast<std::size_t>(out - begin);
+		}
+
+		default:
+			memcpy(out, data, length);
+			return length;
+	}
+}
+
+void decoder::feed(const unsigned char* data, unsigned length, const std::function<void(const unsigned char*, unsigned)>& consume)
+{
+	if (encoding == ENCODING::Raw)
+	{
+		consume(data, length);
+		return;
+	}
+
+	if (pending_length > 0) // complete the group split by the previous segment
+	{
+		while (pending_length < group && length > 0)
+		{
+			pending[pending_length++] = *data++;
+			--length;
+		}
+		if (pending_length < group)
+			return;
+		consume(buffer, static_cast<unsigned>(decode_groups(pending, group, buffer)));
+		pending_length = 0;
+	}
+
+	const std::size_t chunk = sizeof(buffer) / (group == 2 ? 1 : group == 4 ? 3 : 5) * group;
+	std::size_t whole = length / group * group;
+	while (whole > 0)
+	{
+		const std::size_t n = whole < chunk ? whole : chunk;
+		consume(buffer, static_cast<unsigned>(decode_groups(data, n, buffer)));
+		data += n;
+		length -= static_cast<unsigned>(n);
+		whole -= n;
+	}
+
+	memcpy(pending, data, length);
+	pending_length = length;
+}
+
+void decoder::finish(const std::function<void(const unsigned char*, unsigned)>& consume)
+{
+	if (pending_length == 0)
+		return;
+	if (encoding == ENCODING::Hex)
+		throw std::runtime_error("Invalid hex input.");
+
+	memset(pending + pending_length, '=', group - pending_length);
+	pending_length = 0;
+	consume(buffer, static_cast<unsigned>(decode_groups(pending, group, buffer)));
+}
+
+} // namespace hashudr
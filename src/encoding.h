@@ -0,0 +1,68 @@
+ /*
+  *  The contents of this file are subject to the Initial
+  *  Developer's Public License Version 1.0 (the "License");
+  *  you may not use this file except in compliance with the
+  *  License. You may obtain a copy of the License at
+  *  http://www.ibphoenix.com/main.nfs?a=ibphoenix&page=ibp_idpl.
+  *
+  *  Software distributed under the License is distributed AS IS,
+  *  WITHOUT WARRANTY OF ANY KIND, either express or implied.
+  *  See the License for the specific language governing rights
+  *  and limitations under the License.
+  *
+  *  The Original Code was created by Maxim Filatov.
+  *
+  *  Copyright (c) 2022 Maxim Filatov <maksim.filatov@moex.com>
+  *  and all contributors signed below.
+  *
+  *  All Rights Reserved.
+  *  Contributor(s): ______________________________________.
+  */
+
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace hashudr
+{
+
+//-----------------------------------------------------------------------------
+// Text encodings of digests (RFC 4648). Hex runs on AVX2 or SSSE3 when the
+// CPU has it, base64 and base32 are table driven.
+//
+
+enum class ENCODING : short
+{
+	Raw = 0,
+	Hex, Base64, Base64url, Base32
+};
+
+std::size_t encoded_length(const ENCODING encoding, const std::size_t length);
+void encode(const ENCODING encoding, const unsigned char* data, const std::size_t length, char* out); // encoded_length() chars
+std::string encode(const ENCODING encoding, const unsigned char* data, const std::size_t length);
+
+class decoder // streaming, a group split between BLOB segments is carried over to the next one
+{
+public:
+	explicit decoder(const ENCODING encoding);
+
+	void feed(const unsigned char* data, unsigned length, const std::function<void(const unsigned char*, unsigned)>& consume);
+	void finish(const std::function<void(const unsigned char*, unsigned)>& consume); // base64url and base32 may end unpadded
+
+private:
+	std::size_t decode_groups(const unsigned char* data, const std::size_t length, unsigned char* out);
+
+	const ENCODING encoding;
+	const unsigned group;
+	unsigned char pending[8];
+	unsigned pending_length = 0;
+	bool padded = false;
+	unsigned char buffer[4096];
+};
+
+} // namespace hashudr
+
+#endif // ENCODING_H
@@ -25,6 +25,7 @@ namespace hashudr
 {
 
 resorces_pool pool;
+exceptions_cache exceptions_catalog;
 hash_helper helper;
 
 //-----------------------------------------------------------------------------
@@ -35,8 +36,7 @@ attachment_resources::attachment_resources(
 	FB_UDR_STATUS_TYPE* status, FB_UDR_CONTEXT_TYPE* context, const ISC_UINT64 attachment_id) 
 		: attachment_id(attachment_id)
 {
-	snapshot = { status, context, nullptr };
-	pull_up_exceptions();
+	snapshot = { status, context };
 }
 
 attachment_resources::~attachment_resources() noexcept
@@ -47,34 +47,55 @@ const attachment_snapshot* attachment_resources::current_snapshot(FB_UDR_STATUS_
 {
 	if (status) snapshot.status = status;
 	if (context) snapshot.context = context;
-	snapshot.transaction = nullptr;
 	return &snapshot;
 }
 
-const ITransaction* attachment_resources::current_transaction(ITransaction* transaction)
+ITransaction* attachment_resources::current_transaction()
 {
-	if (transaction) snapshot.transaction = transaction;
-	return !snapshot.transaction ?
-				snapshot.context->getTransaction(snapshot.status)
-				: snapshot.transaction;
+	return snapshot.context->getTransaction(snapshot.status);
 }
 
 const ISC_LONG attachment_resources::exception_number(const char* exception_name) // simple find num
 {
-	for (auto x : exceptions)
+	if (!current_exceptions()) return 0;
+	for (auto& x : exceptions)
 		if (strcmp(x.name, exception_name) == 0) return x.number;
 	return 0;
 }
 
 const char* attachment_resources::exception_message(const char* exception_name) // simple find msg
 {
+	if (!current_exceptions()) return nullptr;
 	for (auto& x : exceptions)
 		if (strcmp(x.name, exception_name) == 0) return x.message;
 	return nullptr;
 }
 
+bool attachment_resources::current_exceptions()
+{
+	try
+	{
+		if (!exceptions_pulled || exceptions_generation != exceptions_catalog.generation())
+			pull_up_exceptions();
+		return true;
+	}
+	catch (std::runtime_error const&)
+	{
+		return false; // raise by name only
+	}
+}
+
 void attachment_resources::pull_up_exceptions()
 {
+	const unsigned generation = exceptions_catalog.generation();
+	const std::string database(snapshot.context->getDatabaseName());
+	if (exceptions_catalog.find(database, exceptions))
+	{
+		exceptions_generation = generation;
+		exceptions_pulled = true;
+		return;
+	}
+
 	AutoRelease<IAttachment> att;
 	AutoRelease<ITransaction> tra;
 	AutoRelease<IStatement> stmt;
@@ -124,6 +145,39 @@ SELECT CAST(TRIM(ex.rdb$exception_name) AS VARCHAR(63)) AS name,\
 	{
 		throw std::runtime_error("Pulling exceptions crashed.");
 	}
+
+	exceptions_catalog.store(database, exceptions, generation);
+	exceptions_generation = generation;
+	exceptions_pulled = true;
+}
+
+//-----------------------------------------------------------------------------
+// exceptions_cache
+//
+
+bool exceptions_cache::find(const std::string& database, attachment_exception* exceptions)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	auto database_it = databases.find(database);
+	if (database_it == databases.end())
+		return false;
+	memcpy(exceptions, database_it->second.data(), sizeof(exceptions_array));
+	return true;
+}
+
+void exceptions_cache::store(const std::string& database, const attachment_exception* exceptions, const unsigned generation)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	if (generation != current_generation.load(std::memory_order_relaxed))
+		return; // invalidated while pulling, the catalog may be newer
+	memcpy(databases[database].data(), exceptions, sizeof(exceptions_array));
+}
+
+void exceptions_cache::invalidate(const std::string& database)
+{
+	std::lock_guard<std::mutex> guard(lock);
+	databases.erase(database);
+	current_generation.fetch_add(1, std::memory_order_release); // attachments look into the cache again
 }
 
 //-----------------------------------------------------------------------------
@@ -136,41 +190,60 @@ resorces_pool::resorces_pool()
 
 resorces_pool::~resorces_pool() noexcept
 {
-	for (resources_it = resources_map.begin(); resources_it != resources_map.end(); ++resources_it)
+	for (shard& s : shards)
 	{
-		delete (attachment_resources*)(resources_it->second);
-		resources_map.erase(resources_it);
+		for (auto& resources : s.resources_map)
+			delete resources.second;
+		s.resources_map.clear();
 	}
 }
 
 ISC_UINT64 resorces_pool::initialize_attachment(FB_UDR_STATUS_TYPE* status, FB_UDR_CONTEXT_TYPE* context)
 {
 	ISC_UINT64 att_id = attachment_id(status, context);
-	resources_it = resources_map.find(att_id);
-	if (resources_it == resources_map.end())
+	shard& s = shard_of(att_id);
 	{
-		attachment_resources* att_resources = new attachment_resources(status, context, att_id);
-		resources_map.insert(
-			std::pair<ISC_UINT64, attachment_resources*>(att_id, att_resources));
+		std::shared_lock<std::shared_mutex> read(s.lock);
+		auto resources_it = s.resources_map.find(att_id);
+		if (resources_it != s.resources_map.end())
+		{
+			++resources_it->second->references;
+			return att_id;
+		}
 	}
+
+	// nothing is queried here, exceptions are pulled up on the first error
+	std::unique_lock<std::shared_mutex> write(s.lock);
+	auto resources_it = s.resources_map.find(att_id);
+	if (resources_it != s.resources_map.end())
+		++resources_it->second->references;
+	else
+		s.resources_map.emplace(att_id, new attachment_resources(status, context, att_id));
 	return att_id;
 }
 
 attachment_resources* resorces_pool::current_resources(const ISC_UINT64 attachment_id)
 {
-	attachment_resources* att_resources;
-	resources_it = resources_map.find(attachment_id);
-	att_resources = (resources_it == resources_map.end() ? nullptr : resources_it->second);
-	return att_resources;
+	shard& s = shard_of(attachment_id);
+	std::shared_lock<std::shared_mutex> read(s.lock);
+	auto resources_it = s.resources_map.find(attachment_id);
+	return (resources_it == s.resources_map.end() ? nullptr : resources_it->second);
 }
 
 void resorces_pool::finalize_attachment(const ISC_UINT64 attachment_id)
 {
-	resources_it = resources_map.find(attachment_id);
-	if (resources_it != resources_map.end()) {
-		delete (attachment_resources*)(resources_it->second);
-		resources_map.erase(resources_it);
+	attachment_resources* att_resources = nullptr;
+	shard& s = shard_of(attachment_id);
+	{
+		std::unique_lock<std::shared_mutex> write(s.lock);
+		auto resources_it = s.resources_map.find(attachment_id);
+		if (resources_it != s.resources_map.end() && --resources_it->second->references == 0)
+		{
+			att_resources = resources_it->second;
+			s.resources_map.erase(resources_it);
+		}
 	}
+	delete att_resources;
 }
 
 ISC_UINT64 resorces_pool::attachment_id(FB_UDR_STATUS_TYPE* status, FB_UDR_CONTEXT_TYPE* context)
@@ -204,6 +277,356 @@ ISC_UINT64 resorces_pool::attachment_id(FB_UDR_STATUS_TYPE* status, FB_UDR_CONTE
 	return attachment_id;
 }
 
+//-----------------------------------------------------------------------------
+// digest_memo
+//
+
+void digest_memo::configure(const unsigned entries, const unsigned max_length)
+{
+	capacity = entries;
+	this->max_length = max_length;
+	while (order.size() > capacity)
+	{
+		index.erase(order.back().key);
+		order.pop_back();
+	}
+	hits = misses = 0;
+}
+
+const std::string& digest_memo::key_of(const HASH hash, const unsigned char* data, const unsigned length)
+{
+	probe.assign(reinterpret_cast<const char*>(&hash), sizeof(hash));
+	probe.append(reinterpret_cast<const char*>(data), length);
+	return probe;
+}
+
+bool digest_memo::find(const HASH hash, const unsigned char* data, const unsigned length,
+	unsigned char* digest, unsigned* digest_length)
+{
+	const auto found = index.find(key_of(hash, data, length));
+	if (found == index.end())
+	{
+		++misses;
+		return false;
+	}
+	order.splice(order.begin(), order, found->second);
+	memcpy(digest, found->second->digest, found->second->length);
+	*digest_length = found->second->length;
+	++hits;
+	return true;
+}
+
+void digest_memo::store(const HASH hash, const unsigned char* data, const unsigned length,
+	const unsigned char* digest, const unsigned digest_length)
+{
+	if (!applies(length) || digest_length > sizeof(entry::digest))
+		return;
+	const std::string& key = key_of(hash, data, length);
+	if (index.find(key) != index.end())
+		return;
+	if (order.size() >= capacity) // the least recently used node is reused
+	{
+		index.erase(order.back().key);
+		order.splice(order.begin(), order, std::prev(order.end()));
+		order.front().key = key;
+	}
+	else
+		order.push_front({ key, {}, 0 });
+	memcpy(order.front().digest, digest, digest_length);
+	order.front().length = digest_length;
+	index.emplace(order.front().key, order.begin());
+}
+
+//-----------------------------------------------------------------------------
+// message_description
+//
+
+void message_description::describe(FB_UDR_STATUS_TYPE* status, IMessageMetadata* metadata)
+{
+	const unsigned count = metadata->getCount(status);
+
+	fields.resize(count);
+	for (unsigned i = 0; i < count; ++i)
+	{
+		fields[i].type = metadata->getType(status, i);
+		fields[i].sub_type = metadata->getSubType(status, i);
+		fields[i].scale = metadata->getScale(status, i);
+		fields[i].length = metadata->getLength(status, i);
+		fields[i].char_set = metadata->getCharSet(status, i);
+		fields[i].offset = metadata->getOffset(status, i);
+		fields[i].null_offset = metadata->getNullOffset(status, i);
+	}
+}
+
+//-----------------------------------------------------------------------------
+// keyed_cache
+//
+
+keyed_state* keyed_cache::acquire(const std::string& signature, const std::function<keyed_state*()>& build)
+{
+	if (!state || this->signature != signature)
+	{
+		state.reset(build());
+		this->signature = signature;
+	}
+	else
+		state->reset();
+	return state.get();
+}
+
+//-----------------------------------------------------------------------------
+// thread_budget
+//
+
+class thread_budget // worker threads shared by every statement of the process, never more than the cores
+{
+public:
+	explicit thread_budget(const unsigned wanted)
+	{
+		const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+		unsigned used = busy.load(std::memory_order_relaxed);
+		do
+		{
+			granted = std::min(wanted, (used < cores ? cores - used : 0));
+			if (granted < 2) // the caller works inline
+			{
+				granted = 0;
+				break;
+			}
+		} while (!busy.compare_exchange_weak(used, used + granted, std::memory_order_acq_rel));
+	}
+	~thread_budget()
+	{
+		if (granted)
+			busy.fetch_sub(granted, std::memory_order_acq_rel);
+	}
+
+	unsigned threads() const { return std::max(1u, granted); }
+
+private:
+	static std::atomic<unsigned> busy;
+	unsigned granted = 0;
+};
+
+std::atomic<unsigned> thread_budget::busy{0};
+
+template <typename T>
+class budgeted : public T // a tree hash whose leaves go to threads of the budget, granted for one call at a time
+{
+public:
+	using T::T;
+
+	budgeted& addData(const void* data, const std::size_t length)
+	{
+		const workers lease(base());
+		T::addData(data, length);
+		return *this;
+	};
+	budgeted& finalize() // the batched leaves are hashed here
+	{
+		const workers lease(base());
+		T::finalize();
+		return *this;
+	};
+
+private:
+	T& base() { return *this; } // T converts to any type, so workers(*this) would not pick the base
+
+	class workers
+	{
+	public:
+		explicit workers(T& hash) : hash(hash), budget(std::thread::hardware_concurrency())
+		{
+			hash.setMaxThreads(budget.threads());
+		};
+		~workers() { hash.setMaxThreads(1); };
+
+	private:
+		T& hash;
+		const thread_budget budget;
+	};
+};
+
+//-----------------------------------------------------------------------------
+// merkle_tree
+//
+
+merkle_tree::merkle_tree(const method_descriptor* method, const unsigned fan_out, const unsigned leaf_rows)
+	: method(method), fan_out(fan_out), leaf_rows(leaf_rows)
+{
+	if (method->unavailable)
+		throw std::runtime_error(method->unavailable);
+	if (fan_out < 2 || leaf_rows == 0)
+		throw std::runtime_error("Fan-out must be at least 2 and leaf rows positive.");
+}
+
+void merkle_tree::scan(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+	const std::string& key_column, const std::function<void(const ISC_INT64, const std::vector<unsigned char>&)>& consume)
+{
+	AutoRelease<IStatement> stmt(att->prepare(status, tra, 0, select.c_str(), SQL_DIALECT_CURRENT, IStatement::PREPARE_PREFETCH_METADATA));
+	AutoRelease<IMessageMetadata> meta(stmt->getOutputMetadata(status));
+	message_description row;
+	row.describe(status, meta);
+
+	unsigned key_index = 0;
+	while (key_index < row.count() && key_column != meta->getField(status, key_index))
+		++key_index;
+	if (key_index == row.count())
+		throw std::runtime_error("Key column is not a column of the relation.");
+	const field_description& key = row[key_index];
+	if ((key.type != SQL_SHORT && key.type != SQL_LONG && key.type != SQL_INT64) || key.scale != 0)
+		throw std::runtime_error("Key column must be SMALLINT, INTEGER or BIGINT.");
+
+	std::vector<unsigned char> buffer(meta->getMessageLength(status));
+	AutoRelease<IResultSet> curs(stmt->openCursor(status, tra, NULL, NULL, meta, 0));
+
+	std::vector<unsigned char> encoded;
+	bool first = true;
+	ISC_INT64 previous = 0;
+	while (curs->fetchNext(status, buffer.data()) == IStatus::RESULT_OK)
+	{
+		if (row.null(buffer.data(), key_index))
+			throw std::runtime_error("Key column must not be NULL.");
+		const unsigned char* data = buffer.data() + key.offset;
+		const ISC_INT64 value =
+			key.type == SQL_SHORT ? *(reinterpret_cast<const ISC_SHORT*>(data))
+			: key.type == SQL_LONG ? *(reinterpret_cast<const ISC_LONG*>(data))
+			: *(reinterpret_cast<const ISC_INT64*>(data));
+		if (!first && value <= previous)
+			throw std::runtime_error("Rows must be ordered by a unique key.");
+		first = false;
+		previous = value;
+
+		encoded.clear();
+		helper.encode_row(status, att, tra, row, buffer.data(), &encoded);
+		consume(value, encoded);
+	}
+	curs->close(status);
+	curs.release();
+}
+
+void merkle_tree::build(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+	const std::string& key_column)
+{
+	static const std::string empty;
+	std::unique_ptr<keyed_state> state(method->state(empty));
+
+	tree.assign(1, std::vector<node>());
+	std::vector<node>& leaves = tree[0];
+	scan(status, att, tra, select, key_column, [&](const ISC_INT64 key, const std::vector<unsigned char>& row)
+	{
+		if (leaves.empty() || leaves.back().rows == leaf_rows)
+		{
+			if (!leaves.empty())
+				state->finalize_to(leaves.back().digest, sizeof(node::digest));
+			leaves.push_back({ key, key, 0, {} });
+			state->reset();
+		}
+		state->add_data(row.data(), static_cast<unsigned>(row.size()));
+		leaves.back().high = key;
+		++leaves.back().rows;
+	});
+	if (leaves.empty()) // an empty table is one empty leaf
+	{
+		leaves.push_back({ 0, 0, 0, {} });
+		state->reset();
+	}
+	state->finalize_to(leaves.back().digest, sizeof(node::digest));
+
+	build_levels();
+}
+
+void merkle_tree::build_on(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+	const std::string& key_column, const merkle_tree& bounds)
+{
+	static const std::string empty;
+	std::unique_ptr<keyed_state> state(method->state(empty));
+
+	const std::vector<node>& bound = bounds.tree.front();
+	tree.assign(1, std::vector<node>());
+	std::vector<node>& leaves = tree[0];
+	leaves.push_back({ bound[0].low, bound[0].high, 0, {} });
+	state->reset();
+
+	const auto next_leaf = [&]()
+	{
+		state->finalize_to(leaves.back().digest, sizeof(node::digest));
+		const node& b = bound[leaves.size()];
+		leaves.push_back({ b.low, b.high, 0, {} });
+		state->reset();
+	};
+
+	scan(status, att, tra, select, key_column, [&](const ISC_INT64 key, const std::vector<unsigned char>& row)
+	{
+		while (leaves.size() < bound.size() && key >= bound[leaves.size()].low)
+			next_leaf();
+		state->add_data(row.data(), static_cast<unsigned>(row.size()));
+		++leaves.back().rows;
+	});
+	while (leaves.size() < bound.size())
+		next_leaf();
+	state->finalize_to(leaves.back().digest, sizeof(node::digest));
+
+	build_levels();
+}
+
+void merkle_tree::build_levels()
+{
+	static const std::string empty;
+	std::unique_ptr<keyed_state> state(method->state(empty));
+
+	while (tree.back().size() > 1)
+	{
+		const std::vector<node>& children = tree.back();
+		std::vector<node> parents;
+		parents.reserve((children.size() + fan_out - 1) / fan_out);
+		for (std::size_t first = 0; first < children.size(); first += fan_out)
+		{
+			const std::size_t last = std::min<std::size_t>(first + fan_out, children.size()) - 1;
+			node parent = { children[first].low, children[last].high, 0, {} };
+			state->reset();
+			for (std::size_t i = first; i <= last; ++i)
+			{
+				state->add_data(children[i].digest, method->digest_size);
+				parent.rows += children[i].rows;
+			}
+			state->finalize_to(parent.digest, sizeof(node::digest));
+			parents.push_back(parent);
+		}
+		tree.push_back(std::move(parents));
+	}
+}
+
+std::vector<unsigned> merkle_tree::differing_leaves(const merkle_tree& other) const
+{
+	if (tree.size() != other.tree.size() || tree.front().size() != other.tree.front().size())
+		throw std::runtime_error("Merkle trees cover different key ranges.");
+
+	const auto same = [this](const node& a, const node& b)
+	{
+		return a.rows == b.rows && memcmp(a.digest, b.digest, method->digest_size) == 0;
+	};
+
+	std::vector<unsigned> leaves;
+	std::vector<std::pair<std::size_t, std::size_t>> pending = { { tree.size() - 1, 0 } }; // level, node
+	while (!pending.empty())
+	{
+		const auto [level, index] = pending.back();
+		pending.pop_back();
+		if (same(tree[level][index], other.tree[level][index]))
+			continue;
+		if (level == 0)
+		{
+			leaves.push_back(static_cast<unsigned>(index));
+			continue;
+		}
+		const std::size_t last = std::min<std::size_t>((index + 1) * fan_out, tree[level - 1].size());
+		for (std::size_t child = last; child-- > index * fan_out; )
+			pending.push_back({ level - 1, child });
+	}
+	return leaves;
+}
+
 //-----------------------------------------------------------------------------
 // hash_helper
 //
@@ -213,6 +636,7 @@ void hash_helper::read_blob(attachment_resources* att_resources, ISC_QUAD* in, s
 	const attachment_snapshot* att_snapshot = (att_resources)->current_snapshot();
 
 	AutoRelease<IAttachment> att;
+	AutoRelease<ITransaction> tra;
 	AutoRelease<IBlob> blob;
 
 	try
@@ -221,8 +645,9 @@ void hash_helper::read_blob(attachment_resources* att_resources, ISC_QUAD* in, s
 		unsigned read = 0;
 
 		att.reset(att_snapshot->context->getAttachment(att_snapshot->status));
+		tra.reset(att_resources->current_transaction());
 		blob.reset(att->openBlob(
-			att_snapshot->status, const_cast<ITransaction*>(att_resources->current_transaction()), in, 0, NULL));
+			att_snapshot->status, tra, in, 0, NULL));
 		buffer.reset(new unsigned char[FB_SEGMENT_SIZE]);
 		out->erase();
 		for (bool eof = false; !eof; )
@@ -253,191 +678,3715 @@ void hash_helper::read_blob(attachment_resources* att_resources, ISC_QUAD* in, s
 	}
 }
 
-std::string hash_helper::hash_key(const HASH hash, const std::string* value)
+void hash_helper::stream_blob(attachment_resources* att_resources, ISC_QUAD* in,
+	const std::function<void(ISC_INT64)>& begin, const std::function<void(const unsigned char*, unsigned)>& consume)
 {
-	const auto get_key = [](auto hash, const std::string* value) -> std::string
-	{
-		hash.addData(value->c_str(), value->length());
-		return std::move(hash.finalize().toString());
-	};
+	const attachment_snapshot* att_snapshot = (att_resources)->current_snapshot();
 
-	switch (hash)
-	{
-		case HASH::Invalid:		throw std::runtime_error("Invalid HASH method.");
-		case HASH::Blake1_224:	return std::move(get_key(Chocobo1::Blake1_224(), value));
-		case HASH::Blake1_256:	return std::move(get_key(Chocobo1::Blake1_256(), value));
-		case HASH::Blake1_384:	return std::move(get_key(Chocobo1::Blake1_384(), value));
-		case HASH::Blake1_512:	return std::move(get_key(Chocobo1::Blake1_512(), value));
-		case HASH::Blake2:		return std::move(get_key(Chocobo1::Blake2(), value));
-		case HASH::Blake2s:		return std::move(get_key(Chocobo1::Blake2s(), value));
-		case HASH::Crc_32:		return std::move(get_key(Chocobo1::CRC_32(), value));
-		case HASH::Cshake_128:	throw std::runtime_error("Cshake method is not supported.");
-		case HASH::Cshake_256:	throw std::runtime_error("Cshake method is not supported.");
-		case HASH::Fnv32_1a:	return std::move(get_key(Chocobo1::FNV32_1a(), value));
-		case HASH::Fnv64_1a:	return std::move(get_key(Chocobo1::FNV64_1a(), value));
-		case HASH::Has160:		return std::move(get_key(Chocobo1::HAS_160(), value));
-		case HASH::Md2:			return std::move(get_key(Chocobo1::MD2(), value));
-		case HASH::Md4:			return std::move(get_key(Chocobo1::MD4(), value));
-		case HASH::Md5:			return std::move(get_key(Chocobo1::MD5(), value));
-		case HASH::Ripemd_128:	return std::move(get_key(Chocobo1::RIPEMD_128(), value));
-		case HASH::Ripemd_160:	return std::move(get_key(Chocobo1::RIPEMD_160(), value));
-		case HASH::Ripemd_256:	return std::move(get_key(Chocobo1::RIPEMD_256(), value));
-		case HASH::Ripemd_320:	return std::move(get_key(Chocobo1::RIPEMD_320(), value));
-		case HASH::Siphash:
-		{
-			const unsigned char key[16] = { 0 }; // keep it simple for now
-			return std::move(get_key(Chocobo1::SipHash(key), value));
-		}
-		case HASH::Sha1:		return std::move(get_key(Chocobo1::SHA1(), value));
-		case HASH::Sha2_224:	return std::move(get_key(Chocobo1::SHA2_224(), value));
-		case HASH::Sha2_256:	return std::move(get_key(Chocobo1::SHA2_256(), value));
-		case HASH::Sha2_384:	return std::move(get_key(Chocobo1::SHA2_384(), value));
-		case HASH::Sha2_512:	return std::move(get_key(Chocobo1::SHA2_512(), value));
-		case HASH::Sha2_512_224:	return std::move(get_key(Chocobo1::SHA2_512_224(), value));
-		case HASH::Sha2_512_256:	return std::move(get_key(Chocobo1::SHA2_512_256(), value));
-		case HASH::Sha3_224:	return std::move(get_key(Chocobo1::SHA3_224(), value));
-		case HASH::Sha3_256:	return std::move(get_key(Chocobo1::SHA3_256(), value));
-		case HASH::Sha3_384:	return std::move(get_key(Chocobo1::SHA3_384(), value));
-		case HASH::Sha3_512:	return std::move(get_key(Chocobo1::SHA3_512(), value));
-		case HASH::Shake_128:	throw std::runtime_error("Shake method is not supported.");
-		case HASH::Shake_256:	throw std::runtime_error("Shake method is not supported.");
-		case HASH::Sm3:			return std::move(get_key(Chocobo1::SM3(), value));
-		case HASH::Tiger1_128:	return std::move(get_key(Chocobo1::Tiger1_128(), value));
-		case HASH::Tiger1_160:	return std::move(get_key(Chocobo1::Tiger1_160(), value));
-		case HASH::Tiger1_192:	return std::move(get_key(Chocobo1::Tiger1_192(), value));
-		case HASH::Tiger2_128:	return std::move(get_key(Chocobo1::Tiger2_128(), value));
-		case HASH::Tiger2_160:	return std::move(get_key(Chocobo1::Tiger2_160(), value));
-		case HASH::Tiger2_192:	return std::move(get_key(Chocobo1::Tiger2_192(), value));
-		case HASH::Tuple_hash_128:	throw std::runtime_error("Tuple_hash method is not supported.");
-		case HASH::Tuple_hash_256:	throw std::runtime_error("Tuple_hash method is not supported.");
-		case HASH::Whirlpool:	return std::move(get_key(Chocobo1::Whirlpool(), value));
+	AutoRelease<IAttachment> att;
+	AutoRelease<ITransaction> tra;
 
-		default:
-			throw std::runtime_error("Invalid HASH method.");
+	try
+	{
+		att.reset(att_snapshot->context->getAttachment(att_snapshot->status));
+		tra.reset(att_resources->current_transaction());
+	}
+	catch (...)
+	{
+		throw std::runtime_error("Error reading BLOB to stream.");
 	}
+	stream_blob(att_snapshot->status, att, tra, in, begin, consume);
 }
 
-//-----------------------------------------------------------------------------
-// package hash
-//
+void hash_helper::stream_blob(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, ISC_QUAD* in,
+	const std::function<void(ISC_INT64)>& begin, const std::function<void(const unsigned char*, unsigned)>& consume)
+{
+	AutoRelease<IBlob> blob;
 
-//-----------------------------------------------------------------------------
-// create function key (
-//   hash_ smallint not null
-//   value_ varchar(...) character set none (or blob sub_type binary),
-//  ) returns varchar(128) character set none
-//  external name 'hash!key'
-//  engine udr;
-//
-FB_UDR_BEGIN_FUNCTION(key)
-	
-	DECLARE_RESOURCE
+	try
+	{
+		AutoArrayDelete<unsigned char> buffer;
+		unsigned read = 0;
 
-	enum in : short {
-		hash = 0, value
-	};
+		blob.reset(att->openBlob(status, tra, in, 0, NULL));
+		if (begin)
+		{
+			const ISC_UCHAR info[] = { isc_info_blob_total_length, isc_info_end };
+			ISC_UCHAR result[16];
 
-	AutoArrayDelete<unsigned> in_types;
-	AutoArrayDelete<unsigned> in_sub_types;
-	AutoArrayDelete<unsigned> in_lengths;
-	AutoArrayDelete<unsigned> in_char_sets;
-	AutoArrayDelete<unsigned> in_offsets;
-	AutoArrayDelete<unsigned> in_null_offsets;
-	
-	FB_UDR_CONSTRUCTOR
+			blob->getInfo(status, sizeof(info), info, sizeof(result), result);
+
+			ISC_UCHAR* p = result;
+			if (*p++ != isc_info_blob_total_length)
+				throw;
+			const ISC_USHORT l =
+				static_cast<ISC_USHORT>(isc_vax_integer(reinterpret_cast<const ISC_SCHAR*>(p), 2));
+			p += 2;
+			begin(isc_portable_integer(p, l));
+		}
+		buffer.reset(new unsigned char[FB_SEGMENT_SIZE]);
+		for (bool eof = false; !eof; )
+		{
+			switch (blob->getSegment(status, FB_SEGMENT_SIZE, buffer, &read))
+			{
+				case IStatus::RESULT_OK:
+				case IStatus::RESULT_SEGMENT:
+				{
+					consume(buffer, read);
+					break;
+				}
+				default:
+				{
+					eof = true;
+					continue;
+				}
+			}
+		}
+		blob->close(status);
+		blob.release();
+	}
+	catch (...)
 	{
-		INITIALIZE_RESORCES
+		throw std::runtime_error("Error reading BLOB to stream.");
+	}
+}
 
-		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+void hash_helper::write_blob(attachment_resources* att_resources, ISC_QUAD* out, const ISC_INT64 length,
+	const std::function<void(unsigned char*, unsigned)>& fill)
+{
+	const attachment_snapshot* att_snapshot = (att_resources)->current_snapshot();
 
-		unsigned in_count = in_metadata->getCount(status);
+	AutoRelease<IAttachment> att;
+	AutoRelease<ITransaction> tra;
+	AutoRelease<IBlob> blob;
 
-		in_types.reset(new unsigned[in_count]);
-		in_sub_types.reset(new unsigned[in_count]);
-		in_lengths.reset(new unsigned[in_count]);
-		in_char_sets.reset(new unsigned[in_count]);
-		in_offsets.reset(new unsigned[in_count]);
-		in_null_offsets.reset(new unsigned[in_count]);
+	try
+	{
+		AutoArrayDelete<unsigned char> buffer;
 
-		for (unsigned i = 0; i < in_count; ++i)
+		att.reset(att_snapshot->context->getAttachment(att_snapshot->status));
+		tra.reset(att_resources->current_transaction());
+		blob.reset(att->createBlob(
+			att_snapshot->status, tra, out, 0, NULL));
+		buffer.reset(new unsigned char[FB_SEGMENT_SIZE]);
+		for (ISC_INT64 left = length; left > 0; )
 		{
-			in_types[i] = in_metadata->getType(status, i);
-			in_sub_types[i] = in_metadata->getSubType(status, i);
-			in_lengths[i] = in_metadata->getLength(status, i);
-			in_char_sets[i] = in_metadata->getCharSet(status, i);
-			in_offsets[i] = in_metadata->getOffset(status, i);
-			in_null_offsets[i] = in_metadata->getNullOffset(status, i);
+			const unsigned segment = static_cast<unsigned>(std::min<ISC_INT64>(left, FB_SEGMENT_SIZE));
+			fill(buffer, segment); // segment by segment, the whole stream is never buffered
+			blob->putSegment(att_snapshot->status, segment, buffer);
+			left -= segment;
 		}
+		blob->close(att_snapshot->status);
+		blob.release();
 	}
+	catch (...)
+	{
+		throw std::runtime_error("Error writing stream to BLOB.");
+	}
+}
 
-	FB_UDR_DESTRUCTOR
+void hash_helper::read_value(attachment_resources* att_resources, const field_description& field, const unsigned char* message, std::string* out)
+{
+	switch (field.type)
 	{
-		FINALIZE_RESORCES
+		case SQL_TEXT: // char
+		case SQL_VARYING: // varchar
+		{
+			if (field.char_set != 0 /* CS_NONE */)
+				throw std::runtime_error("CS_NONE character set is allowed.");
+			ISC_USHORT length =
+				static_cast<ISC_USHORT>(
+					(field.type == SQL_TEXT ?
+						field.length :	// full CHAR(N) length including trailing spaces
+						*(reinterpret_cast<const ISC_USHORT*>(message + field.offset))
+						)
+					);
+			out->assign(
+				reinterpret_cast<const char*>(message + (field.type == SQL_TEXT ? 0 : sizeof(ISC_USHORT)) + field.offset),
+				length
+			);
+			break;
+		}
+		case SQL_BLOB: // blob
+		{
+			if (field.sub_type != 0 /* SUB_TYPE BINARY */)
+				throw std::runtime_error("SUB_TYPE BINARY is allowed for BLOB.");
+			read_blob(att_resources, reinterpret_cast<ISC_QUAD*>(const_cast<unsigned char*>(message) + field.offset), out);
+			break;
+		}
+		default:
+			throw std::runtime_error("Allowed [VAR]CHAR(N) or BLOB SQL datatype.");
 	}
+}
 
-	FB_UDR_MESSAGE(
-		OutMessage,
-		(FB_VARCHAR(128), key)
-	);
+void hash_helper::write_string(const field_description& field, unsigned char* message, const std::string& value)
+{
+	if (value.length() > field.length)
+		throw std::runtime_error("Result does not fit the output datatype.");
 
-	FB_UDR_EXECUTE_FUNCTION
+	switch (field.type)
 	{
+		case SQL_TEXT: // char, binary(N) is padded with zeros
+		{
+			memcpy(message + field.offset, value.c_str(), value.length());
+			memset(message + field.offset + value.length(), (field.char_set == 1 /* CS_BINARY */ ? '\0' : ' '), field.length - value.length());
+			break;
+		}
+		case SQL_VARYING: // varchar
+		{
+			*(reinterpret_cast<ISC_USHORT*>(message + field.offset)) = static_cast<ISC_USHORT>(value.length());
+			memcpy(message + field.offset + sizeof(ISC_USHORT), value.c_str(), value.length());
+			break;
+		}
+		default:
+			throw std::runtime_error("Allowed [VAR]CHAR(N) result SQL datatype.");
+	}
+}
+
+void hash_helper::write_bytes(attachment_resources* att_resources, const field_description& field, unsigned char* message,
+	const std::vector<unsigned char>& value)
+{
+	if (field.type == SQL_BLOB) // raw
+	{
+		ISC_INT64 offset = 0;
+		write_blob(att_resources, reinterpret_cast<ISC_QUAD*>(message + field.offset), static_cast<ISC_INT64>(value.size()),
+			[&value, &offset](unsigned char* buffer, unsigned length)
+			{
+				memcpy(buffer, value.data() + offset, length);
+				offset += length;
+			});
+	}
+	else if (field.char_set == 1 /* CS_BINARY */) // raw [var]binary(N)
+		write_string(field, message, std::string(value.begin(), value.end()));
+	else // hex, same as the digest strings
+		write_string(field, message, encode(ENCODING::Hex, value.data(), value.size()));
+}
+
+void hash_helper::write_octets(const field_description& field, unsigned char* message, const unsigned char* value, const unsigned length)
+{
+	if ((field.type != SQL_TEXT && field.type != SQL_VARYING) || field.char_set != 1 /* CS_BINARY */)
+		throw std::runtime_error("Allowed [VAR]CHAR(N) CHARACTER SET OCTETS result SQL datatype.");
+	if (length > field.length)
+		throw std::runtime_error("Result does not fit the output datatype.");
+
+	if (field.type == SQL_TEXT) // binary(N) is padded with zeros
+	{
+		memcpy(message + field.offset, value, length);
+		memset(message + field.offset + length, '\0', field.length - length);
+	}
+	else
+	{
+		*(reinterpret_cast<ISC_USHORT*>(message + field.offset)) = static_cast<ISC_USHORT>(length);
+		memcpy(message + field.offset + sizeof(ISC_USHORT), value, length);
+	}
+}
+
+void hash_helper::write_integer(const field_description& field, unsigned char* message, const unsigned char* digest, const unsigned length)
+{
+	const auto fold = [digest, length](auto value) // leading bytes big-endian, same as operator T() of the hash classes
+	{
+		for (unsigned i = 0; i < std::min<unsigned>(sizeof(value), length); ++i)
+			value = static_cast<decltype(value)>((value << 8) | digest[i]);
+		return value;
+	};
+
+	switch (field.type)
+	{
+		case SQL_SHORT:	*reinterpret_cast<ISC_SHORT*>(message + field.offset) = static_cast<ISC_SHORT>(fold(ISC_USHORT(0))); break;
+		case SQL_LONG:	*reinterpret_cast<ISC_LONG*>(message + field.offset) = static_cast<ISC_LONG>(fold(ISC_ULONG(0))); break;
+		case SQL_INT64:	*reinterpret_cast<ISC_INT64*>(message + field.offset) = static_cast<ISC_INT64>(fold(ISC_UINT64(0))); break;
+
+		default:
+			throw std::runtime_error("Allowed SMALLINT, INTEGER or BIGINT result SQL datatype.");
+	}
+}
+
+unsigned hash_helper::bytes_capacity(const field_description& field)
+{
+	if (field.type == SQL_BLOB)
+		return UINT_MAX;
+	return (field.char_set == 1 /* CS_BINARY */ ? field.length : field.length / 2);
+}
+
+std::string hash_helper::xof_key(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+	const field_description& field, const unsigned char* message)
+{
+	const auto get_key = [&](auto hash) -> std::string
+	{
+		feed_value(att_resources, field, message,
+			[&hash](const unsigned char* data, unsigned length) { hash.addData(data, length); });
+		return hash.finalize().toString();
+	};
+	const auto get_tuple = [&](auto tuple) -> std::string // the value is the only element, its length is announced first
+	{
+		feed_value(att_resources, field, message,
+			[&tuple](const unsigned char* data, unsigned length) { tuple.addData(data, length); },
+			[&tuple](ISC_INT64 length) { tuple.nextElement(static_cast<std::size_t>(length)); });
+		return tuple.finalize().toString();
+	};
+	const auto no_custom = [custom]()
+	{
+		if (!custom->empty())
+			throw std::runtime_error("HASH method does not take customization.");
+	};
+
+	switch (hash)
+	{
+		case HASH::Cshake_128:	return get_key(Chocobo1::CSHAKE_128(digest, "", *custom));
+		case HASH::Cshake_256:	return get_key(Chocobo1::CSHAKE_256(digest, "", *custom));
+		case HASH::Shake_128:	no_custom(); return get_key(Chocobo1::SHAKE_128(digest));
+		case HASH::Shake_256:	no_custom(); return get_key(Chocobo1::SHAKE_256(digest));
+		case HASH::Kangaroo_twelve:	return get_key(budgeted<Chocobo1::KangarooTwelve>(digest, *custom));
+		case HASH::Turboshake_128:	no_custom(); return get_key(Chocobo1::TurboSHAKE_128(digest));
+		case HASH::Turboshake_256:	no_custom(); return get_key(Chocobo1::TurboSHAKE_256(digest));
+		case HASH::Tuple_hash_128:	return get_tuple(Chocobo1::TupleHash_128(digest, *custom));
+		case HASH::Tuple_hash_256:	return get_tuple(Chocobo1::TupleHash_256(digest, *custom));
+
+		default:
+			throw std::runtime_error("HASH method has no extendable output.");
+	}
+}
+
+void hash_helper::xof_blob(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+	const field_description& field, const unsigned char* message, ISC_QUAD* out)
+{
+	const auto put_key = [&](auto hash)
+	{
+		feed_value(att_resources, field, message,
+			[&hash](const unsigned char* data, unsigned length) { hash.addData(data, length); });
+		hash.finalize(); // zero digest length, output is squeezed straight into BLOB segments
+		write_blob(att_resources, out, digest,
+			[&hash](unsigned char* buffer, unsigned length) { hash.squeeze(buffer, length); });
+	};
+	const auto no_custom = [custom]()
+	{
+		if (!custom->empty())
+			throw std::runtime_error("HASH method does not take customization.");
+	};
+
+	switch (hash)
+	{
+		case HASH::Cshake_128:	put_key(Chocobo1::CSHAKE_128(0, "", *custom)); break;
+		case HASH::Cshake_256:	put_key(Chocobo1::CSHAKE_256(0, "", *custom)); break;
+		case HASH::Shake_128:	no_custom(); put_key(Chocobo1::SHAKE_128(0)); break;
+		case HASH::Shake_256:	no_custom(); put_key(Chocobo1::SHAKE_256(0)); break;
+		case HASH::Kangaroo_twelve:	put_key(budgeted<Chocobo1::KangarooTwelve>(0, *custom)); break;
+		case HASH::Turboshake_128:	no_custom(); put_key(Chocobo1::TurboSHAKE_128(0)); break;
+		case HASH::Turboshake_256:	no_custom(); put_key(Chocobo1::TurboSHAKE_256(0)); break;
+
+		default:
+			throw std::runtime_error("HASH method has no extendable output.");
+	}
+}
+
+std::string hash_helper::tuple_key(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+	const message_description& in_message, const unsigned char* in, const unsigned first)
+{
+	// big-endian fixed width, so equal values of one datatype encode equally on any platform
+	const auto encode = [](auto tuple, const ISC_UINT64 value, const unsigned size)
+	{
+		unsigned char buffer[sizeof(ISC_UINT64)];
+		for (unsigned i = 0; i < size; ++i)
+			buffer[i] = static_cast<unsigned char>(value >> (8 * (size - 1 - i)));
+		tuple->nextData(buffer, size);
+	};
+	const auto encode_integer = [](auto tuple, const ISC_INT64 value, const int scale)
+	{
+		unsigned char buffer[sizeof(ISC_INT64) + 1];
+		for (unsigned i = 0; i < sizeof(ISC_INT64); ++i)
+			buffer[i] = static_cast<unsigned char>(static_cast<ISC_UINT64>(value) >> (8 * (sizeof(ISC_INT64) - 1 - i)));
+		buffer[sizeof(ISC_INT64)] = static_cast<unsigned char>(static_cast<signed char>(scale));
+		tuple->nextData(buffer, sizeof(buffer));
+	};
+
+	const auto get_key = [&](auto tuple) -> std::string
+	{
+		for (unsigned i = first; i < in_message.count(); ++i)
+		{
+			const field_description& field = in_message[i];
+			const unsigned char* data = in + field.offset;
+			switch (field.type)
+			{
+				case SQL_TEXT: // char, full length including trailing spaces
+					tuple.nextData(data, field.length);
+					break;
+				case SQL_VARYING: // varchar
+					tuple.nextData(data + sizeof(ISC_USHORT), *(reinterpret_cast<const ISC_USHORT*>(data)));
+					break;
+				case SQL_BLOB: // streamed, element length comes from BLOB info
+					stream_blob(att_resources, reinterpret_cast<ISC_QUAD*>(const_cast<unsigned char*>(data)),
+						[&tuple](ISC_INT64 length) { tuple.nextElement(static_cast<std::size_t>(length)); },
+						[&tuple](const unsigned char* segment, unsigned length) { tuple.addData(segment, length); });
+					break;
+				case SQL_SHORT: // smallint, integer, bigint and numerics as 64-bit integer and scale
+					encode_integer(&tuple, *(reinterpret_cast<const ISC_SHORT*>(data)), field.scale);
+					break;
+				case SQL_LONG:
+					encode_integer(&tuple, *(reinterpret_cast<const ISC_LONG*>(data)), field.scale);
+					break;
+				case SQL_INT64:
+					encode_integer(&tuple, *(reinterpret_cast<const ISC_INT64*>(data)), field.scale);
+					break;
+				case SQL_FLOAT: // float and double as IEEE 754 double
+				case SQL_DOUBLE:
+				{
+					const double d = (field.type == SQL_FLOAT ?
+						static_cast<double>(*(reinterpret_cast<const float*>(data)))
+						: *(reinterpret_cast<const double*>(data)));
+					ISC_UINT64 bits;
+					memcpy(&bits, &d, sizeof(bits));
+					encode(&tuple, bits, sizeof(bits));
+					break;
+				}
+				case SQL_BOOLEAN:
+					encode(&tuple, *data ? 1 : 0, 1);
+					break;
+				case SQL_TYPE_DATE:
+				case SQL_TYPE_TIME:
+					encode(&tuple, *(reinterpret_cast<const ISC_ULONG*>(data)), sizeof(ISC_ULONG));
+					break;
+				case SQL_TIMESTAMP:
+				{
+					const ISC_TIMESTAMP* ts = reinterpret_cast<const ISC_TIMESTAMP*>(data);
+					encode(&tuple,
+						(static_cast<ISC_UINT64>(static_cast<ISC_ULONG>(ts->timestamp_date)) << 32) | ts->timestamp_time,
+						sizeof(ISC_UINT64));
+					break;
+				}
+				default:
+					throw std::runtime_error("Tuple element SQL datatype is not supported.");
+			}
+		}
+		return tuple.finalize().toString();
+	};
+
+	switch (hash)
+	{
+		case HASH::Tuple_hash_128:	return get_key(Chocobo1::TupleHash_128(digest, *custom));
+		case HASH::Tuple_hash_256:	return get_key(Chocobo1::TupleHash_256(digest, *custom));
+
+		default:
+			throw std::runtime_error("HASH method is not a tuple hash.");
+	}
+}
+
+IAttachment* hash_helper::attach_database(FB_UDR_STATUS_TYPE* status, IMaster* master, const std::string& database, const std::string& user,
+	const std::string& role)
+{
+	// embedded in the server process, the engine provider takes the user name without password
+	AutoRelease<IProvider> provider(master->getDispatcher());
+	AutoDispose<IXpbBuilder> dpb(master->getUtilInterface()->getXpbBuilder(status, IXpbBuilder::DPB, NULL, 0));
+	dpb->insertString(status, isc_dpb_user_name, user.c_str());
+	if (!role.empty() && role != "NONE") // quoted, the name is taken as it is
+		dpb->insertString(status, isc_dpb_sql_role_name, quoted(role, '"').c_str());
+
+	return provider->attachDatabase(status, database.c_str(), dpb->getBufferLength(status), dpb->getBuffer(status));
+}
+
+std::string hash_helper::current_role(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra)
+{
+	AutoRelease<IStatement> stmt(att->prepare(status, tra, 0, "SELECT CURRENT_ROLE FROM rdb$database",
+		SQL_DIALECT_CURRENT, IStatement::PREPARE_PREFETCH_METADATA));
+	AutoRelease<IMessageMetadata> meta(stmt->getOutputMetadata(status));
+	message_description row;
+	row.describe(status, meta);
+	std::vector<unsigned char> buffer(meta->getMessageLength(status));
+	AutoRelease<IResultSet> curs(stmt->openCursor(status, tra, NULL, NULL, meta, 0));
+
+	std::string role;
+	if (curs->fetchNext(status, buffer.data()) == IStatus::RESULT_OK && !row.null(buffer.data(), 0))
+	{
+		const field_description& field = row[0];
+		const unsigned char* data = buffer.data() + field.offset;
+		if (field.type == SQL_VARYING)
+			role.assign(reinterpret_cast<const char*>(data + sizeof(ISC_USHORT)), *reinterpret_cast<const ISC_USHORT*>(data));
+		else
+			role.assign(reinterpret_cast<const char*>(data), field.length);
+		role.erase(role.find_last_not_of(' ') + 1);
+	}
+	curs->close(status);
+	curs.release();
+	return role;
+}
+
+std::string hash_helper::error_text(IMaster* master, const FbException& e)
+{
+	char text[512];
+	master->getUtilInterface()->formatStatus(text, sizeof(text), e.getStatus());
+	return text;
+}
+
+std::string hash_helper::quoted(const std::string& text, const char quote)
+{
+	std::string out(1, quote);
+	for (const char c : text)
+	{
+		out += c;
+		if (c == quote)
+			out += quote;
+	}
+	out += quote;
+	return out;
+}
+
+void hash_helper::encode_field(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra,
+	const message_description& row, const unsigned char* message, const unsigned index,
+	const std::function<void(const unsigned char*, unsigned)>& consume)
+{
+	// 0 for NULL, or a type class tag and the big-endian value, so equal rows
+	// encode equally whatever the column datatypes widths and the platform
+	unsigned char head[1 + 2 * sizeof(ISC_INT64)];
+	unsigned used = 0;
+	const auto put = [&head, &used](const ISC_UINT64 value, const unsigned size)
+	{
+		for (unsigned i = 0; i < size; ++i)
+			head[used++] = static_cast<unsigned char>(value >> (8 * (size - 1 - i)));
+	};
+	const auto put_bytes = [&](const unsigned char* data, const unsigned length)
+	{
+		put(length, sizeof(ISC_ULONG));
+		consume(head, used);
+		consume(data, length);
+	};
+
+	const field_description& field = row[index];
+	const unsigned char* data = message + field.offset;
+	if (row.null(message, index))
+	{
+		head[used++] = 0;
+		consume(head, used);
+		return;
+	}
+	switch (field.type)
+	{
+		case SQL_TEXT: // char, full length including trailing spaces
+			head[used++] = 'T';
+			put_bytes(data, field.length);
+			return;
+		case SQL_VARYING:
+			head[used++] = 'T';
+			put_bytes(data + sizeof(ISC_USHORT), *(reinterpret_cast<const ISC_USHORT*>(data)));
+			return;
+		case SQL_SHORT: // smallint, integer, bigint and numerics as 64-bit integer and scale
+		case SQL_LONG:
+		case SQL_INT64:
+		{
+			const ISC_INT64 value =
+				field.type == SQL_SHORT ? *(reinterpret_cast<const ISC_SHORT*>(data))
+				: field.type == SQL_LONG ? *(reinterpret_cast<const ISC_LONG*>(data))
+				: *(reinterpret_cast<const ISC_INT64*>(data));
+			head[used++] = 'I';
+			put(static_cast<ISC_UINT64>(value), sizeof(ISC_INT64));
+			head[used++] = static_cast<unsigned char>(static_cast<signed char>(field.scale));
+			break;
+		}
+		case SQL_FLOAT: // float and double as IEEE 754 double
+		case SQL_DOUBLE:
+		{
+			const double d = (field.type == SQL_FLOAT ?
+				static_cast<double>(*(reinterpret_cast<const float*>(data)))
+				: *(reinterpret_cast<const double*>(data)));
+			ISC_UINT64 bits;
+			memcpy(&bits, &d, sizeof(bits));
+			head[used++] = 'F';
+			put(bits, sizeof(bits));
+			break;
+		}
+		case SQL_BOOLEAN:
+			head[used++] = 'B';
+			head[used++] = (*data ? 1 : 0);
+			break;
+		case SQL_TYPE_DATE:
+			head[used++] = 'D';
+			put(*(reinterpret_cast<const ISC_ULONG*>(data)), sizeof(ISC_ULONG));
+			break;
+		case SQL_TYPE_TIME:
+			head[used++] = 'M';
+			put(*(reinterpret_cast<const ISC_ULONG*>(data)), sizeof(ISC_ULONG));
+			break;
+		case SQL_TIMESTAMP:
+		{
+			const ISC_TIMESTAMP* ts = reinterpret_cast<const ISC_TIMESTAMP*>(data);
+			head[used++] = 'S';
+			put(static_cast<ISC_ULONG>(ts->timestamp_date), sizeof(ISC_ULONG));
+			put(ts->timestamp_time, sizeof(ISC_ULONG));
+			break;
+		}
+		case SQL_BLOB: // total length first, then the segments
+			head[used++] = 'L';
+			stream_blob(status, att, tra, reinterpret_cast<ISC_QUAD*>(const_cast<unsigned char*>(data)),
+				[&](ISC_INT64 length) { put(static_cast<ISC_UINT64>(length), sizeof(ISC_INT64)); consume(head, used); },
+				consume);
+			return;
+		default:
+			throw std::runtime_error("Row column SQL datatype is not supported, cast it.");
+	}
+	consume(head, used);
+}
+
+void hash_helper::encode_row(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra,
+	const message_description& row, const unsigned char* message, std::vector<unsigned char>* out)
+{
+	for (unsigned i = 0; i < row.count(); ++i)
+		encode_field(status, att, tra, row, message, i,
+			[out](const unsigned char* data, unsigned length) { out->insert(out->end(), data, data + length); });
+}
+
+void hash_helper::feed_value(attachment_resources* att_resources, const field_description& field, const unsigned char* message,
+	const std::function<void(const unsigned char*, unsigned)>& consume, const std::function<void(ISC_INT64)>& begin)
+{
+	switch (field.type)
+	{
+		case SQL_TEXT: // char
+		case SQL_VARYING: // varchar
+		{
+			if (field.char_set != 0 /* CS_NONE */)
+				throw std::runtime_error("CS_NONE character set is allowed.");
+			const unsigned length = (field.type == SQL_TEXT ?
+				field.length : *(reinterpret_cast<const ISC_USHORT*>(message + field.offset)));
+			if (begin)
+				begin(length);
+			consume(message + field.offset + (field.type == SQL_TEXT ? 0 : sizeof(ISC_USHORT)), length);
+			break;
+		}
+		case SQL_BLOB: // blob, segment by segment
+		{
+			if (field.sub_type != 0 /* SUB_TYPE BINARY */)
+				throw std::runtime_error("SUB_TYPE BINARY is allowed for BLOB.");
+			stream_blob(att_resources, reinterpret_cast<ISC_QUAD*>(const_cast<unsigned char*>(message) + field.offset), begin, consume);
+			break;
+		}
+		default:
+			throw std::runtime_error("Allowed [VAR]CHAR(N) or BLOB SQL datatype.");
+	}
+}
+
+keyed_state* hash_helper::kmac_state(const HASH hash, const ISC_LONG digest, const std::string* key, const std::string* custom)
+{
+	switch (hash)
+	{
+		case HASH::Kmac_128:	return new keyed_state_of<Chocobo1::KMAC_128>(Chocobo1::KMAC_128(digest, *key, *custom));
+		case HASH::Kmac_256:	return new keyed_state_of<Chocobo1::KMAC_256>(Chocobo1::KMAC_256(digest, *key, *custom));
+		case HASH::Kmacxof_128:	return new keyed_state_of<Chocobo1::KMACXOF_128>(Chocobo1::KMACXOF_128(digest, *key, *custom));
+		case HASH::Kmacxof_256:	return new keyed_state_of<Chocobo1::KMACXOF_256>(Chocobo1::KMACXOF_256(digest, *key, *custom));
+
+		default:
+			throw std::runtime_error("HASH method is not a KMAC.");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// Method registry
+//
+
+template <typename T>
+struct method_kernels // type-erased entries of a method with a fixed digest length
+{
+	static T make() { return T(); };
+
+	static keyed_state* state(const std::string& prefix)
+	{
+		return new prefixed_state<T>(make(), prefix);
+	};
+
+	static unsigned digest(const unsigned char* data, const unsigned length, unsigned char* out, const unsigned capacity)
+	{
+		T hash = make();
+		hash.addData(data, length);
+		return finalize_hash(hash, out, capacity);
+	};
+
+	static void batch(const unsigned char* const* data, const unsigned* lengths, const unsigned count,
+		unsigned char* out, const unsigned stride) // one value after another, no multi-buffer kernel
+	{
+		const T initial = make();
+		for (unsigned i = 0; i < count; ++i)
+		{
+			T hash = initial;
+			hash.addData(data[i], lengths[i]);
+			finalize_hash(hash, out + static_cast<std::size_t>(i) * stride, stride);
+		}
+	};
+};
+
+template <>
+Chocobo1::SipHash method_kernels<Chocobo1::SipHash>::make()
+{
+	const unsigned char key[16] = { 0 }; // keep it simple for now
+	return Chocobo1::SipHash(key);
+}
+
+template <>
+budgeted<Chocobo1::KangarooTwelve> method_kernels<budgeted<Chocobo1::KangarooTwelve>>::make() { return budgeted<Chocobo1::KangarooTwelve>(32); }
+template <>
+Chocobo1::TurboSHAKE_128 method_kernels<Chocobo1::TurboSHAKE_128>::make() { return Chocobo1::TurboSHAKE_128(32); }
+template <>
+Chocobo1::TurboSHAKE_256 method_kernels<Chocobo1::TurboSHAKE_256>::make() { return Chocobo1::TurboSHAKE_256(64); }
+
+template <typename T, int BLOCK>
+struct hmac_kernels
+{
+	using hmac = Chocobo1::HMAC<T, BLOCK>;
+
+	static keyed_state* state(const std::string& key)
+	{
+		return new keyed_state_of<hmac>(hmac(key));
+	};
+
+	static std::vector<unsigned char> pbkdf2(const std::string& password, const std::string& salt,
+		const unsigned iterations, const unsigned length)
+	{
+		// a key of one output block, the usual password hash, derives inline; longer keys
+		// split their blocks over the threads left in the shared budget
+		const std::size_t block = hmac(std::string()).finalize().toSpan().size();
+		const unsigned blocks = static_cast<unsigned>((length + block - 1) / block);
+		if (blocks < 2)
+			return Chocobo1::PBKDF2<hmac>(password, salt, iterations, length);
+		const thread_budget budget(blocks);
+		return Chocobo1::PBKDF2<hmac>(password, salt, iterations, length, budget.threads());
+	};
+
+	static std::vector<unsigned char> hkdf(const std::string& ikm, const std::string& salt,
+		const std::string& info, const unsigned length)
+	{
+		try
+		{
+			return Chocobo1::HKDF<hmac>(ikm, salt, info, length);
+		}
+		catch (std::invalid_argument const&)
+		{
+			throw std::runtime_error("Key length exceeds 255 digests of HASH method.");
+		}
+	};
+};
+
+template <typename T, int BLOCK, bool HMAC = true>
+static constexpr method_descriptor fixed(const HASH hash, const char* name, const unsigned digest_size,
+	const unsigned kernels = KERNEL_PORTABLE)
+{
+	if constexpr (HMAC)
+		return { hash, name, digest_size, BLOCK, kernels, nullptr,
+			&method_kernels<T>::state, &method_kernels<T>::digest, &method_kernels<T>::batch,
+			&hmac_kernels<T, BLOCK>::state, &hmac_kernels<T, BLOCK>::pbkdf2, &hmac_kernels<T, BLOCK>::hkdf };
+	else
+		return { hash, name, digest_size, BLOCK, kernels, nullptr,
+			&method_kernels<T>::state, &method_kernels<T>::digest, &method_kernels<T>::batch,
+			nullptr, nullptr, nullptr };
+}
+
+static constexpr method_descriptor unbound(const HASH hash, const char* name, const unsigned digest_size,
+	const unsigned block_size, const char* unavailable)
+{
+	return { hash, name, digest_size, block_size, KERNEL_PORTABLE, unavailable,
+		nullptr, nullptr, nullptr, nullptr, nullptr, nullptr };
+}
+
+static constexpr method_descriptor registry[] = {
+	unbound(HASH::Invalid, "", 0, 0, "Invalid HASH method."),
+	fixed<Chocobo1::Blake1_224, 64>(HASH::Blake1_224, "blake1_224", 28),
+	fixed<Chocobo1::Blake1_256, 64>(HASH::Blake1_256, "blake1_256", 32),
+	fixed<Chocobo1::Blake1_384, 128>(HASH::Blake1_384, "blake1_384", 48),
+	fixed<Chocobo1::Blake1_512, 128>(HASH::Blake1_512, "blake1_512", 64),
+	fixed<Chocobo1::Blake2, 128>(HASH::Blake2, "blake2", 64),
+	fixed<Chocobo1::Blake2s, 64>(HASH::Blake2s, "blake2s", 32),
+	fixed<Chocobo1::CRC_32, 1, false>(HASH::Crc_32, "crc_32", 4),
+	unbound(HASH::Cshake_128, "cshake_128", 0, 168, "Cshake method requires digest length, use key3."),
+	unbound(HASH::Cshake_256, "cshake_256", 0, 136, "Cshake method requires digest length, use key3."),
+	fixed<Chocobo1::FNV32_1a, 1, false>(HASH::Fnv32_1a, "fnv32_1a", 4),
+	fixed<Chocobo1::FNV64_1a, 1, false>(HASH::Fnv64_1a, "fnv64_1a", 8),
+	fixed<Chocobo1::HAS_160, 64>(HASH::Has160, "has160", 20),
+	fixed<Chocobo1::MD2, 16>(HASH::Md2, "md2", 16),
+	fixed<Chocobo1::MD4, 64>(HASH::Md4, "md4", 16),
+	fixed<Chocobo1::MD5, 64>(HASH::Md5, "md5", 16),
+	fixed<Chocobo1::RIPEMD_128, 64>(HASH::Ripemd_128, "ripemd_128", 16),
+	fixed<Chocobo1::RIPEMD_160, 64>(HASH::Ripemd_160, "ripemd_160", 20),
+	fixed<Chocobo1::RIPEMD_256, 64>(HASH::Ripemd_256, "ripemd_256", 32),
+	fixed<Chocobo1::RIPEMD_320, 64>(HASH::Ripemd_320, "ripemd_320", 40),
+	fixed<Chocobo1::SipHash, 8, false>(HASH::Siphash, "siphash", 8),
+	fixed<Chocobo1::SHA1, 64>(HASH::Sha1, "sha1", 20),
+	fixed<Chocobo1::SHA2_224, 64>(HASH::Sha2_224, "sha2_224", 28),
+	fixed<Chocobo1::SHA2_256, 64>(HASH::Sha2_256, "sha2_256", 32),
+	fixed<Chocobo1::SHA2_384, 128>(HASH::Sha2_384, "sha2_384", 48),
+	fixed<Chocobo1::SHA2_512, 128>(HASH::Sha2_512, "sha2_512", 64),
+	fixed<Chocobo1::SHA2_512_224, 128>(HASH::Sha2_512_224, "sha2_512_224", 28),
+	fixed<Chocobo1::SHA2_512_256, 128>(HASH::Sha2_512_256, "sha2_512_256", 32),
+	fixed<Chocobo1::SHA3_224, (1152 / 8)>(HASH::Sha3_224, "sha3_224", 28),
+	fixed<Chocobo1::SHA3_256, (1088 / 8)>(HASH::Sha3_256, "sha3_256", 32),
+	fixed<Chocobo1::SHA3_384, (832 / 8)>(HASH::Sha3_384, "sha3_384", 48),
+	fixed<Chocobo1::SHA3_512, (576 / 8)>(HASH::Sha3_512, "sha3_512", 64),
+	unbound(HASH::Shake_128, "shake_128", 0, 168, "Shake method requires digest length, use key3."),
+	unbound(HASH::Shake_256, "shake_256", 0, 136, "Shake method requires digest length, use key3."),
+	fixed<Chocobo1::SM3, 64>(HASH::Sm3, "sm3", 32),
+	fixed<Chocobo1::Tiger1_128, 64>(HASH::Tiger1_128, "tiger1_128", 16),
+	fixed<Chocobo1::Tiger1_160, 64>(HASH::Tiger1_160, "tiger1_160", 20),
+	fixed<Chocobo1::Tiger1_192, 64>(HASH::Tiger1_192, "tiger1_192", 24),
+	fixed<Chocobo1::Tiger2_128, 64>(HASH::Tiger2_128, "tiger2_128", 16),
+	fixed<Chocobo1::Tiger2_160, 64>(HASH::Tiger2_160, "tiger2_160", 20),
+	fixed<Chocobo1::Tiger2_192, 64>(HASH::Tiger2_192, "tiger2_192", 24),
+	unbound(HASH::Tuple_hash_128, "tuple_hash_128", 0, 168, "Tuple_hash method requires digest length, use key3 or tuple."),
+	unbound(HASH::Tuple_hash_256, "tuple_hash_256", 0, 136, "Tuple_hash method requires digest length, use key3 or tuple."),
+	fixed<Chocobo1::Whirlpool, 64>(HASH::Whirlpool, "whirlpool", 64),
+	fixed<budgeted<Chocobo1::KangarooTwelve>, 168, false>(HASH::Kangaroo_twelve, "kangaroo_twelve", 32, KERNEL_PORTABLE | KERNEL_THREADS),
+	fixed<Chocobo1::TurboSHAKE_128, 168, false>(HASH::Turboshake_128, "turboshake_128", 32),
+	fixed<Chocobo1::TurboSHAKE_256, 136, false>(HASH::Turboshake_256, "turboshake_256", 64),
+	unbound(HASH::Kmac_128, "kmac_128", 0, 168, "Kmac method requires key, use kmac."),
+	unbound(HASH::Kmac_256, "kmac_256", 0, 136, "Kmac method requires key, use kmac."),
+	unbound(HASH::Kmacxof_128, "kmacxof_128", 0, 168, "Kmac method requires key, use kmac."),
+	unbound(HASH::Kmacxof_256, "kmacxof_256", 0, 136, "Kmac method requires key, use kmac."),
+	fixed<budgeted<Chocobo1::TigerTree>, 1024, false>(HASH::Tiger_tree, "tiger_tree", 24, KERNEL_PORTABLE | KERNEL_THREADS),
+	unbound(HASH::Poly1305, "poly1305", 16, 16, "Mac method requires key, use umac."),
+	unbound(HASH::Vmac, "vmac", 8, 128, "Mac method requires key, use umac.")
+};
+
+static constexpr bool registry_in_enum_order()
+{
+	for (std::size_t i = 0; i < std::size(registry); ++i)
+		if (static_cast<std::size_t>(registry[i].hash) != i)
+			return false;
+	return true;
+}
+static_assert(registry_in_enum_order(), "method registry must follow the HASH enum");
+
+const method_descriptor& method_of(const HASH hash)
+{
+	const std::size_t index = static_cast<std::size_t>(static_cast<unsigned short>(hash));
+	return index < std::size(registry) ? registry[index] : registry[0];
+}
+
+const method_descriptor* methods_begin() { return std::begin(registry) + 1; } // without Invalid
+const method_descriptor* methods_end() { return std::end(registry); }
+
+keyed_state* hash_helper::hmac_state(const HASH hash, const std::string* key)
+{
+	const method_descriptor& method = method_of(hash);
+	if (!method.hmac_state)
+		throw std::runtime_error("HASH method has no HMAC.");
+	return method.hmac_state(*key);
+}
+
+std::vector<unsigned char> hash_helper::pbkdf2(const HASH hash, const std::string* password, const std::string* salt,
+	const ISC_LONG iterations, const ISC_LONG length)
+{
+	if (iterations <= 0 || length <= 0)
+		throw std::runtime_error("Iteration count and key length must be positive.");
+
+	const method_descriptor& method = method_of(hash);
+	if (!method.pbkdf2)
+		throw std::runtime_error("HASH method has no HMAC.");
+	return method.pbkdf2(*password, *salt, static_cast<unsigned>(iterations), static_cast<unsigned>(length));
+}
+
+std::vector<unsigned char> hash_helper::hkdf(const HASH hash, const std::string* ikm, const std::string* salt,
+	const std::string* info, const ISC_LONG length)
+{
+	if (length <= 0)
+		throw std::runtime_error("Key length must be positive.");
+
+	const method_descriptor& method = method_of(hash);
+	if (!method.hkdf)
+		throw std::runtime_error("HASH method has no HMAC.");
+	return method.hkdf(*ikm, *salt, *info, static_cast<unsigned>(length));
+}
+
+keyed_state* hash_helper::prefix_state(const HASH hash, const std::string* prefix)
+{
+	const method_descriptor& method = method_of(hash);
+	if (method.unavailable)
+		throw std::runtime_error(method.unavailable);
+	return method.state(*prefix);
+}
+
+keyed_state* hash_helper::digest_state(const HASH hash)
+{
+	static const std::string empty;
+	return prefix_state(hash, &empty);
+}
+
+HASH hash_helper::method(const std::string& name)
+{
+	std::string lower(name);
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+	for (const method_descriptor* m = methods_begin(); m != methods_end(); ++m)
+		if (lower == m->name) return m->hash;
+	return HASH::Invalid;
+}
+
+HASH hash_helper::entry_method(FB_UDR_STATUS_TYPE* status, IRoutineMetadata* metadata)
+{
+	const std::string entry_point(metadata->getEntryPoint(status));
+	const std::size_t routine = entry_point.find('!');
+	const std::size_t info = routine == std::string::npos ? std::string::npos : entry_point.find('!', routine + 1);
+	if (info == std::string::npos)
+		return HASH::Invalid;
+
+	const HASH hash = method(entry_point.substr(info + 1));
+	if (hash == HASH::Invalid)
+		throw std::runtime_error("Unknown HASH method in external name.");
+	return hash;
+}
+
+keyed_state* hash_helper::mac_state(const HASH hash, const std::string* key)
+{
+	switch (hash)
+	{
+		case HASH::Siphash:
+			if (key->length() != 16)
+				throw std::runtime_error("Siphash method requires 16 byte key.");
+			return new keyed_state_of<Chocobo1::SipHash>(
+				Chocobo1::SipHash({ reinterpret_cast<const unsigned char*>(key->data()), key->length() }));
+		case HASH::Poly1305:
+			if (key->length() != 32)
+				throw std::runtime_error("Poly1305 method requires 32 byte one-time key.");
+			return new keyed_state_of<Chocobo1::Poly1305>(Chocobo1::Poly1305(*key));
+		case HASH::Vmac:		return new nonced_state<Chocobo1::VMAC_64>(Chocobo1::VMAC_64(*key));
+
+		default:
+			throw std::runtime_error("HASH method is not a MAC, use hmac or kmac.");
+	}
+}
+
+//-----------------------------------------------------------------------------
+// package hash
+//
+
+//-----------------------------------------------------------------------------
+// create function key (
+//   hash_ smallint not null
+//   value_ varchar(...) character set none (or blob sub_type binary),
+//  ) returns varchar(128) character set none
+//  external name 'hash!key'
+//  engine udr;
+//
+// create function sha2_256 (
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(128) character set none
+//  external name 'hash!key!sha2_256'
+//  engine udr;
+//
+// The method named in the external name is bound once in the constructor,
+// no selector and no method switch per row.
+//
+FB_UDR_BEGIN_FUNCTION(key)
+	
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, value
+	};
+
+	message_description in_message;
+
+	keyed_cache cache;
+	std::unique_ptr<keyed_state> bound_state; // 'hash!key!method'
+	HASH bound_hash = HASH::Invalid;
+	unsigned value_field = in::value;
+	
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+
+		try
+		{
+			const HASH bound = helper.entry_method(status, metadata);
+			if (bound != HASH::Invalid)
+			{
+				bound_state.reset(helper.digest_state(bound));
+				bound_hash = bound;
+				value_field = 0;
+			}
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_VARCHAR(128), key)
+	);
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out->keyNull = FB_TRUE;
+		if (!in_message.null(in, value_field))
+		{
+			try
+			{
+				// no heap on this path for [VAR]CHAR: the value is hashed in the message buffer,
+				// the state is restored from the cached initial one, the digest is encoded into out
+				const HASH hash =
+					bound_state ? bound_hash
+					: !in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+
+				// short CS_NONE values may be answered by the attachment's memo, see memoize
+				const field_description& field = in_message[value_field];
+				digest_memo& memo = att_resources->memo;
+				const unsigned char* text = nullptr;
+				unsigned text_length = 0;
+				if ((field.type == SQL_TEXT || field.type == SQL_VARYING) && field.char_set == 0 /* CS_NONE */)
+				{
+					text = in + field.offset + (field.type == SQL_TEXT ? 0 : sizeof(ISC_USHORT));
+					text_length = (field.type == SQL_TEXT ? field.length : *(reinterpret_cast<const ISC_USHORT*>(in + field.offset)));
+				}
+				const bool memoized = text && memo.applies(text_length);
+
+				unsigned char digest[64]; // the longest fixed digest
+				unsigned length = 0;
+				if (!memoized || !memo.find(hash, text, text_length, digest, &length))
+				{
+					keyed_state* state = bound_state.get();
+					if (state)
+						state->reset();
+					else
+						state = cache.acquire(std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)),
+							[&]() { return helper.digest_state(hash); });
+					helper.feed_value(att_resources, field, in,
+						[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+					length = state->finalize_to(digest, sizeof(digest));
+					if (memoized)
+						memo.store(hash, text, text_length, digest, length);
+				}
+				encode(ENCODING::Hex, digest, length, out->key.str);
+				out->key.length = static_cast<ISC_USHORT>(length * 2);
+				out->keyNull = FB_FALSE;
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		} 
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function xof (
+//   hash_ smallint not null,
+//   digest integer not null,
+//   custom varchar(...) character set none,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(...) character set none (or blob sub_type binary)
+//  external name 'hash!xof'
+//  engine udr;
+//
+// VARCHAR result is the hex digest, BLOB result is the raw extendable output.
+//
+FB_UDR_BEGIN_FUNCTION(xof)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, digest, custom, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ISC_LONG digest =
+					!in_message.null(in, in::digest) ?
+						*reinterpret_cast<ISC_LONG*>(in + in_message[in::digest].offset)
+						: 0;
+				if (digest <= 0)
+					throw std::runtime_error("Digest length must be positive.");
+
+				std::string custom;
+				if (!in_message.null(in, in::custom))
+					helper.read_value(att_resources, in_message[in::custom], in, &custom);
+
+				if (out_message[out::key].type == SQL_BLOB)
+					helper.xof_blob(att_resources, hash, digest, &custom, in_message[in::value], in,
+						reinterpret_cast<ISC_QUAD*>(out + out_message[out::key].offset));
+				else
+				{
+					if (digest > static_cast<ISC_LONG>(out_message[out::key].length / 2))
+						throw std::runtime_error("Digest length exceeds the result datatype, use BLOB.");
+					helper.write_string(out_message[out::key], out,
+						helper.xof_key(att_resources, hash, digest, &custom, in_message[in::value], in));
+				}
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function tuple (
+//   hash_ smallint not null,
+//   digest integer not null,
+//   custom varchar(...) character set none,
+//   value1 ..., value2 ..., ... valueN ...
+//  ) returns varchar(...) character set none
+//  external name 'hash!tuple'
+//  engine udr;
+//
+// Every value is one TupleHash element read directly from the input message:
+// [VAR]CHAR(N) of any character set and BLOB as is, integer types and numerics
+// as 64-bit big-endian followed by the scale byte (NUMERIC(10,2) 1.00 and
+// INTEGER 100 differ), floating point as IEEE 754 double, date/time types as
+// stored. NULL in any value gives NULL.
+//
+FB_UDR_BEGIN_FUNCTION(tuple)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, digest, custom, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		for (unsigned i = in::value; i < in_message.count(); ++i)
+			if (in_message.null(in, i))
+				return;
+		try
+		{
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			const ISC_LONG digest =
+				!in_message.null(in, in::digest) ?
+					*reinterpret_cast<ISC_LONG*>(in + in_message[in::digest].offset)
+					: 0;
+			if (digest <= 0 || digest > static_cast<ISC_LONG>(out_message[out::key].length / 2))
+				throw std::runtime_error("Digest length must be positive and fit the result datatype.");
+
+			std::string custom;
+			if (!in_message.null(in, in::custom))
+				helper.read_value(att_resources, in_message[in::custom], in, &custom);
+
+			helper.write_string(out_message[out::key], out,
+				helper.tuple_key(att_resources, hash, digest, &custom, in_message, in, in::value));
+			out_message.set_null(out, out::key, false);
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function kmac (
+//   hash_ smallint not null,
+//   digest integer not null,
+//   key_ varchar(...) character set none,
+//   custom varchar(...) character set none,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(...) character set none
+//  external name 'hash!kmac'
+//  engine udr;
+//
+// The padded key is absorbed once per (hash_, digest, key_, custom) and kept
+// by the routine instance, so a call with the same key absorbs value_ only.
+//
+FB_UDR_BEGIN_FUNCTION(kmac)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, digest, key, custom, value
+	};
+
+	enum out : short {
+		mac = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::mac, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ISC_LONG digest =
+					!in_message.null(in, in::digest) ?
+						*reinterpret_cast<ISC_LONG*>(in + in_message[in::digest].offset)
+						: 0;
+				if (digest <= 0 || digest > static_cast<ISC_LONG>(out_message[out::mac].length / 2))
+					throw std::runtime_error("Digest length must be positive and fit the result datatype.");
+
+				std::string key, custom;
+				if (!in_message.null(in, in::key))
+					helper.read_value(att_resources, in_message[in::key], in, &key);
+				if (!in_message.null(in, in::custom))
+					helper.read_value(att_resources, in_message[in::custom], in, &custom);
+
+				std::string signature(reinterpret_cast<const char*>(&hash), sizeof(hash));
+				signature.append(reinterpret_cast<const char*>(&digest), sizeof(digest));
+				const ISC_ULONG key_length = static_cast<ISC_ULONG>(key.length());
+				signature.append(reinterpret_cast<const char*>(&key_length), sizeof(key_length));
+				signature.append(key).append(custom);
+
+				keyed_state* state = cache.acquire(signature,
+					[&]() { return helper.kmac_state(hash, digest, &key, &custom); });
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				helper.write_string(out_message[out::mac], out, state->finalize());
+				out_message.set_null(out, out::mac, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function hmac (
+//   hash_ smallint not null,
+//   key_ varchar(...) character set none,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(128) character set none
+//  external name 'hash!hmac'
+//  engine udr;
+//
+// K0 ^ ipad and K0 ^ opad are compressed once per (hash_, key_), a call with
+// the same key costs the message blocks plus one outer block.
+//
+FB_UDR_BEGIN_FUNCTION(hmac)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, key, value
+	};
+
+	enum out : short {
+		mac = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::mac, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+
+				std::string key;
+				if (!in_message.null(in, in::key))
+					helper.read_value(att_resources, in_message[in::key], in, &key);
+
+				std::string signature(reinterpret_cast<const char*>(&hash), sizeof(hash));
+				signature.append(key);
+
+				keyed_state* state = cache.acquire(signature,
+					[&]() { return helper.hmac_state(hash, &key); });
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				helper.write_string(out_message[out::mac], out, state->finalize());
+				out_message.set_null(out, out::mac, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function prefix (
+//   hash_ smallint not null,
+//   prefix_ varchar(...) character set none,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(128) character set none
+//  external name 'hash!prefix'
+//  engine udr;
+//
+// Same as key(hash_, prefix_ || value_). The state after prefix_ is kept by
+// the routine instance, so a constant salt is compressed once per statement.
+//
+FB_UDR_BEGIN_FUNCTION(prefix)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, prefix, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+
+				std::string prefix;
+				if (!in_message.null(in, in::prefix))
+					helper.read_value(att_resources, in_message[in::prefix], in, &prefix);
+
+				std::string signature(reinterpret_cast<const char*>(&hash), sizeof(hash));
+				signature.append(prefix);
+
+				keyed_state* state = cache.acquire(signature,
+					[&]() { return helper.prefix_state(hash, &prefix); });
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				helper.write_string(out_message[out::key], out, state->finalize());
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function pbkdf2 (
+//   hash_ smallint not null,
+//   password varchar(...) character set none,
+//   salt varchar(...) character set none,
+//   iterations integer not null,
+//   length_ integer not null
+//  ) returns varchar(...) character set none (hex), varbinary(...) or blob sub_type binary (raw)
+//  external name 'hash!pbkdf2'
+//  engine udr;
+//
+// PBKDF2-HMAC (RFC 8018). Every iteration restarts from the keyed HMAC
+// midstates, output blocks of a long key are derived on separate threads.
+//
+FB_UDR_BEGIN_FUNCTION(pbkdf2)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, password, salt, iterations, length
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::password))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ISC_LONG iterations =
+					!in_message.null(in, in::iterations) ?
+						*reinterpret_cast<ISC_LONG*>(in + in_message[in::iterations].offset)
+						: 0;
+				const ISC_LONG length =
+					!in_message.null(in, in::length) ?
+						*reinterpret_cast<ISC_LONG*>(in + in_message[in::length].offset)
+						: 0;
+				if (length > 0 && static_cast<unsigned>(length) > helper.bytes_capacity(out_message[out::key]))
+					throw std::runtime_error("Key length exceeds the result datatype.");
+
+				std::string password, salt;
+				helper.read_value(att_resources, in_message[in::password], in, &password);
+				if (!in_message.null(in, in::salt))
+					helper.read_value(att_resources, in_message[in::salt], in, &salt);
+
+				helper.write_bytes(att_resources, out_message[out::key], out,
+					helper.pbkdf2(hash, &password, &salt, iterations, length));
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function hkdf (
+//   hash_ smallint not null,
+//   ikm varchar(...) character set none,
+//   salt varchar(...) character set none,
+//   info varchar(...) character set none,
+//   length_ integer not null
+//  ) returns varchar(...) character set none (hex), varbinary(...) or blob sub_type binary (raw)
+//  external name 'hash!hkdf'
+//  engine udr;
+//
+// HKDF extract-and-expand (RFC 5869), NULL salt is HashLen zeros.
+//
+FB_UDR_BEGIN_FUNCTION(hkdf)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, ikm, salt, info, length
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::ikm))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ISC_LONG length =
+					!in_message.null(in, in::length) ?
+						*reinterpret_cast<ISC_LONG*>(in + in_message[in::length].offset)
+						: 0;
+				if (length > 0 && static_cast<unsigned>(length) > helper.bytes_capacity(out_message[out::key]))
+					throw std::runtime_error("Key length exceeds the result datatype.");
+
+				std::string ikm, salt, info;
+				helper.read_value(att_resources, in_message[in::ikm], in, &ikm);
+				if (!in_message.null(in, in::salt))
+					helper.read_value(att_resources, in_message[in::salt], in, &salt);
+				if (!in_message.null(in, in::info))
+					helper.read_value(att_resources, in_message[in::info], in, &info);
+
+				helper.write_bytes(att_resources, out_message[out::key], out,
+					helper.hkdf(hash, &ikm, &salt, &info, length));
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create procedure tree (
+//   hash_ smallint not null,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns (
+//   level_ integer,
+//   node integer,
+//   digest varchar(48) character set none
+//  )
+//  external name 'hash!tree'
+//  engine udr;
+//
+// Every node of the hash tree, level 0 are the leaves, the last level is the
+// root. Ranges of value_ can later be verified against the stored nodes
+// without rehashing the whole value.
+//
+FB_UDR_BEGIN_PROCEDURE(tree)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, value
+	};
+
+	enum out : short {
+		level = 0, node, digest
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+		attachment_resources* att_resources = nullptr;
+
+		ATTACHMENT_RESORCES
+		if (procedure->in_message.null(in, in::value))
+			return;
+		try
+		{
+			const HASH hash =
+				!procedure->in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + procedure->in_message[in::hash].offset))
+					: HASH::Invalid;
+			if (hash != HASH::Tiger_tree)
+				throw std::runtime_error("HASH method is not a tree hash.");
+
+			budgeted<Chocobo1::TigerTree> tree;
+			tree.setKeepLevels(true);
+			helper.feed_value(att_resources, procedure->in_message[in::value], in,
+				[&tree](const unsigned char* data, unsigned length) { tree.addData(data, length); });
+			levels = tree.finalize().levels();
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	std::vector<Chocobo1::TigerTree::Level> levels;
+	unsigned level = 0, node = 0;
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (level >= levels.size())
+			return false;
+
+		const message_description& out_message = procedure->out_message;
+		const Chocobo1::TigerTree::ResultArrayType& digest = levels[level][node];
+		*reinterpret_cast<ISC_LONG*>(out + out_message[out::level].offset) = static_cast<ISC_LONG>(level);
+		*reinterpret_cast<ISC_LONG*>(out + out_message[out::node].offset) = static_cast<ISC_LONG>(node);
+		helper.write_bytes(nullptr, out_message[out::digest], out, { digest.begin(), digest.end() }); // hex or raw, never BLOB
+		out_message.set_null(out, out::level, false);
+		out_message.set_null(out, out::node, false);
+		out_message.set_null(out, out::digest, false);
+
+		if (++node >= levels[level].size())
+		{
+			node = 0;
+			++level;
+		}
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create function umac (
+//   hash_ smallint not null,
+//   key_ varchar(...) character set none,
+//   nonce varchar(...) character set none,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(32) character set none
+//  external name 'hash!umac'
+//  engine udr;
+//
+// Siphash takes a 16 byte key, Vmac any key and a nonce that must not repeat
+// under it. Poly1305 takes a 32 byte one-time key and no nonce: a key must
+// authenticate one message only, two tags under one key reveal r and allow
+// forgeries. The Siphash and Vmac key schedules are kept per (hash_, key_),
+// a Poly1305 key is never kept.
+//
+FB_UDR_BEGIN_FUNCTION(umac)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, key, nonce, value
+	};
+
+	enum out : short {
+		mac = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::mac, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+
+				std::string key;
+				if (!in_message.null(in, in::key))
+					helper.read_value(att_resources, in_message[in::key], in, &key);
+				std::string nonce;
+				const bool has_nonce = !in_message.null(in, in::nonce);
+				if (has_nonce)
+					helper.read_value(att_resources, in_message[in::nonce], in, &nonce);
+
+				std::string signature(reinterpret_cast<const char*>(&hash), sizeof(hash));
+				signature.append(key);
+
+				std::unique_ptr<keyed_state> one_time; // Poly1305, one message per key
+				keyed_state* state;
+				if (hash == HASH::Poly1305)
+				{
+					one_time.reset(helper.mac_state(hash, &key));
+					state = one_time.get();
+				}
+				else
+					state = cache.acquire(signature,
+						[&]() { return helper.mac_state(hash, &key); });
+				state->nonce(has_nonce ? &nonce : nullptr);
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				helper.write_string(out_message[out::mac], out, state->finalize());
+				out_message.set_null(out, out::mac, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function encoded (
+//   hash_ smallint not null,
+//   input_ smallint, -- encoding of value_, null is raw
+//   output_ smallint, -- encoding of the digest, null is hex
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(128) character set none
+//  external name 'hash!encoded'
+//  engine udr;
+//
+// value_ is decoded segment by segment while it is hashed, no SQL-side
+// conversion. Base64 output is a third shorter than hex.
+//
+FB_UDR_BEGIN_FUNCTION(encoded)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, input, output, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ENCODING input =
+					!in_message.null(in, in::input) ?
+						static_cast<ENCODING>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::input].offset))
+						: ENCODING::Raw;
+				const ENCODING output =
+					!in_message.null(in, in::output) ?
+						static_cast<ENCODING>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::output].offset))
+						: ENCODING::Hex;
+
+				keyed_state* state = cache.acquire(std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)),
+					[&]() { return helper.digest_state(hash); });
+				decoder decode(input);
+				const auto consume = [state](const unsigned char* data, unsigned length) { state->add_data(data, length); };
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[&decode, &consume](const unsigned char* data, unsigned length) { decode.feed(data, length, consume); });
+				decode.finish(consume);
+
+				const std::vector<unsigned char> digest = state->finalize_bytes();
+				helper.write_string(out_message[out::key], out, encode(output, digest.data(), digest.size()));
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function raw (
+//   hash_ smallint not null,
+//   length_ integer, -- leading bytes of the digest, null is the whole digest
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns varchar(64) character set octets (or char(n) character set octets)
+//  external name 'hash!raw'
+//  engine udr;
+//
+// The digest bytes are copied into the message as they are, half the width of
+// the hex key in indexes and foreign keys.
+//
+FB_UDR_BEGIN_FUNCTION(raw)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, length, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+				const ISC_LONG length =
+					!in_message.null(in, in::length) ? *reinterpret_cast<ISC_LONG*>(in + in_message[in::length].offset) : 0;
+				if (length < 0)
+					throw std::runtime_error("Truncation length must not be negative.");
+
+				keyed_state* state = cache.acquire(std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)),
+					[&]() { return helper.digest_state(hash); });
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				unsigned char digest[64]; // the longest fixed digest
+				const unsigned digest_length = state->finalize_to(digest, sizeof(digest));
+				if (static_cast<unsigned>(length) > digest_length)
+					throw std::runtime_error("Truncation length exceeds the digest length.");
+
+				helper.write_octets(out_message[out::key], out, digest, length > 0 ? static_cast<unsigned>(length) : digest_length);
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function integer (
+//   hash_ smallint not null,
+//   value_ varchar(...) character set none (or blob sub_type binary)
+//  ) returns bigint (or integer, smallint) deterministic
+//  external name 'hash!integer'
+//  engine udr;
+//
+// The leading digest bytes as a signed integer, for hash-partitioned and
+// expression-indexed columns. No strings on the way.
+//
+FB_UDR_BEGIN_FUNCTION(integer)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, value
+	};
+
+	enum out : short {
+		key = 0
+	};
+
+	message_description in_message;
+	message_description out_message;
+
+	keyed_cache cache;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+		AutoRelease<IMessageMetadata> out_metadata(metadata->getOutputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+		out_message.describe(status, out_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out_message.set_null(out, out::key, true);
+		if (!in_message.null(in, in::value))
+		{
+			try
+			{
+				const HASH hash =
+					!in_message.null(in, in::hash) ?
+						static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+						: HASH::Invalid;
+
+				keyed_state* state = cache.acquire(std::string(reinterpret_cast<const char*>(&hash), sizeof(hash)),
+					[&]() { return helper.digest_state(hash); });
+				helper.feed_value(att_resources, in_message[in::value], in,
+					[state](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+
+				unsigned char digest[sizeof(ISC_INT64)];
+				const unsigned length = state->finalize_to(digest, sizeof(digest));
+				helper.write_integer(out_message[out::key], out, digest, std::min<unsigned>(length, sizeof(digest)));
+				out_message.set_null(out, out::key, false);
+			}
+			catch (std::runtime_error const& e)
+			{
+				HASHUDR_THROW(e.what())
+			}
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create procedure methods
+//  returns (
+//   hash_ smallint,
+//   name varchar(32) character set none,
+//   digest_size integer,
+//   block_size integer,
+//   streaming boolean,
+//   hmac boolean,
+//   threads boolean
+//  )
+//  external name 'hash!methods'
+//  engine udr;
+//
+// The method registry as a table: what every selector can do. threads is set
+// when one large value is hashed on worker threads; batches of values (digests,
+// row_digests) are hashed one value after another by every method.
+//
+FB_UDR_BEGIN_PROCEDURE(methods)
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_SMALLINT, hash)
+		(FB_VARCHAR(32), name)
+		(FB_INTEGER, digest_size)
+		(FB_INTEGER, block_size)
+		(FB_BOOLEAN, streaming)
+		(FB_BOOLEAN, hmac)
+		(FB_BOOLEAN, threads)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+	}
+
+	const method_descriptor* method = methods_begin();
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (method == methods_end())
+			return false;
+
+		out->hashNull = FB_FALSE;
+		out->hash = static_cast<ISC_SHORT>(method->hash);
+		out->nameNull = FB_FALSE;
+		out->name.length = static_cast<ISC_USHORT>(strlen(method->name));
+		memcpy(out->name.str, method->name, out->name.length);
+		out->digest_sizeNull = (method->digest_size == 0 ? FB_TRUE : FB_FALSE); // the caller gives the length
+		out->digest_size = static_cast<ISC_LONG>(method->digest_size);
+		out->block_sizeNull = FB_FALSE;
+		out->block_size = static_cast<ISC_LONG>(method->block_size);
+		out->streamingNull = FB_FALSE;
+		out->streaming = (method->state ? FB_TRUE : FB_FALSE);
+		out->hmacNull = FB_FALSE;
+		out->hmac = (method->hmac_state ? FB_TRUE : FB_FALSE);
+		out->threadsNull = FB_FALSE;
+		out->threads = ((method->kernels & KERNEL_THREADS) ? FB_TRUE : FB_FALSE);
+
+		++method;
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create function digests (
+//   hash_ smallint not null,
+//   lines boolean not null, -- LF or CRLF terminated records, false is 4 byte big-endian length prefixed
+//   records blob sub_type binary
+//  ) returns blob sub_type binary
+//  external name 'hash!digests'
+//  engine udr;
+//
+// One call for a whole load: the digests of the records, digest_size bytes
+// each and in record order. Both BLOBs are streamed, records are hashed
+// BATCH_RECORDS at a time through the method's batch entry. A line's
+// terminating CR LF or LF is not hashed. Text BLOBs are refused, their
+// transliteration would change the records.
+//
+FB_UDR_BEGIN_FUNCTION(digests)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, lines, records
+	};
+
+	static constexpr unsigned BATCH_RECORDS = 256;
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_BLOB, digests)
+	);
+
+	struct framed_records // records of a batch back to back, a record split between segments is carried over
+	{
+		std::vector<unsigned char> data;
+		std::vector<unsigned> offsets = { 0 };
+		unsigned char prefix[sizeof(ISC_ULONG)];
+		unsigned prefix_length = 0;
+		ISC_ULONG left = 0; // bytes of the current length prefixed record still to come
+
+		unsigned count() const { return static_cast<unsigned>(offsets.size() - 1); };
+		void close() { offsets.push_back(static_cast<unsigned>(data.size())); };
+		void clear() { data.clear(); offsets.assign(1, 0); };
+	};
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		out->digestsNull = FB_TRUE;
+		if (in_message.null(in, in::records))
+			return;
+		try
+		{
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			const bool lines = *(in + in_message[in::lines].offset) != 0;
+			if (in_message[in::records].sub_type != 0 /* SUB_TYPE BINARY */)
+				throw std::runtime_error("SUB_TYPE BINARY is allowed for BLOB.");
+			const method_descriptor& method = method_of(hash);
+			if (method.unavailable)
+				throw std::runtime_error(method.unavailable);
+
+			AutoRelease<IAttachment> att;
+			AutoRelease<ITransaction> tra;
+			AutoRelease<IBlob> blob;
+			try
+			{
+				att.reset(context->getAttachment(status));
+				tra.reset(att_resources->current_transaction());
+				blob.reset(att->createBlob(status, tra, &out->digests, 0, NULL));
+			}
+			catch (...)
+			{
+				throw std::runtime_error("Error writing stream to BLOB.");
+			}
+
+			framed_records batch;
+			std::vector<const unsigned char*> data;
+			std::vector<unsigned> lengths;
+			std::vector<unsigned char> digests;
+			const auto flush = [&]()
+			{
+				if (batch.count() == 0)
+					return;
+				data.resize(batch.count());
+				lengths.resize(batch.count());
+				for (unsigned i = 0; i < batch.count(); ++i)
+				{
+					data[i] = batch.data.data() + batch.offsets[i];
+					lengths[i] = batch.offsets[i + 1] - batch.offsets[i];
+				}
+				digests.resize(static_cast<std::size_t>(batch.count()) * method.digest_size);
+				method.batch(data.data(), lengths.data(), batch.count(), digests.data(), method.digest_size);
+				try
+				{
+					blob->putSegment(status, static_cast<unsigned>(digests.size()), digests.data());
+				}
+				catch (...)
+				{
+					throw std::runtime_error("Error writing stream to BLOB.");
+				}
+				batch.clear();
+			};
+			const auto close = [&]()
+			{
+				if (lines && batch.data.size() > batch.offsets.back() && batch.data.back() == '\r')
+					batch.data.pop_back(); // CR LF
+				batch.close();
+				if (batch.count() == BATCH_RECORDS)
+					flush();
+			};
+
+			helper.stream_blob(status, att, tra, reinterpret_cast<ISC_QUAD*>(in + in_message[in::records].offset), nullptr,
+				[&](const unsigned char* segment, unsigned length)
+				{
+					const unsigned char* end = segment + length;
+					while (segment < end)
+					{
+						if (lines)
+						{
+							const unsigned char* eol = static_cast<const unsigned char*>(memchr(segment, '\n', end - segment));
+							batch.data.insert(batch.data.end(), segment, eol ? eol : end);
+							if (!eol)
+								break;
+							segment = eol + 1;
+							close();
+						}
+						else if (batch.prefix_length < sizeof(batch.prefix))
+						{
+							batch.prefix[batch.prefix_length++] = *segment++;
+							if (batch.prefix_length == sizeof(batch.prefix))
+							{
+								batch.left = 0;
+								for (const unsigned char b : batch.prefix)
+									batch.left = (batch.left << 8) | b;
+								if (batch.left == 0)
+								{
+									batch.prefix_length = 0;
+									close();
+								}
+							}
+						}
+						else
+						{
+							const ISC_ULONG part = std::min<ISC_ULONG>(batch.left, static_cast<ISC_ULONG>(end - segment));
+							batch.data.insert(batch.data.end(), segment, segment + part);
+							segment += part;
+							if ((batch.left -= part) == 0)
+							{
+								batch.prefix_length = 0;
+								close();
+							}
+						}
+					}
+				});
+			if (lines && batch.data.size() > batch.offsets.back()) // the last line may go without a newline
+				close();
+			else if (!lines && batch.prefix_length != 0)
+				throw std::runtime_error("Length prefixed record is truncated.");
+			flush();
+
+			try
+			{
+				blob->close(status);
+				blob.release();
+			}
+			catch (...)
+			{
+				throw std::runtime_error("Error writing stream to BLOB.");
+			}
+			out->digestsNull = FB_FALSE;
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function invalidate
+//  returns integer
+//  external name 'hash!invalidate'
+//  engine udr;
+//
+// Forgets the cached HASH$ exceptions of the current database, call it after
+// the exceptions are created or altered. Attachments read rdb$exceptions again
+// on their next error.
+//
+FB_UDR_BEGIN_FUNCTION(invalidate)
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(RESULT_BLANK, result)
+	);
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		exceptions_catalog.invalidate(context->getDatabaseName());
+		out->resultNull = FB_FALSE;
+		out->result = BLANK;
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create function memoize (
+//   entries integer not null, -- 0 switches the memo off
+//   max_length integer not null
+//  ) returns integer
+//  external name 'hash!memoize'
+//  engine udr;
+//
+// Sizes the attachment's memo of key digests: up to entries of the most
+// recently hashed [VAR]CHAR values of max_length bytes or less. Only the
+// unkeyed key routine consults it, the key is (method, value).
+//
+FB_UDR_BEGIN_FUNCTION(memoize)
+
+	DECLARE_RESOURCE
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		InMessage,
+		(FB_INTEGER, entries)
+		(FB_INTEGER, max_length)
+	);
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(RESULT_BLANK, result)
+	);
+
+	FB_UDR_EXECUTE_FUNCTION
+	{
+		ATTACHMENT_RESORCES
+		if (in->entriesNull || in->max_lengthNull || in->entries < 0 || in->max_length < 0)
+			HASHUDR_THROW("Memo entries and max length must be zero or positive.")
+		att_resources->memo.configure(static_cast<unsigned>(in->entries), static_cast<unsigned>(in->max_length));
+		out->resultNull = FB_FALSE;
+		out->result = BLANK;
+	}
+
+FB_UDR_END_FUNCTION
+
+//-----------------------------------------------------------------------------
+// create procedure memo_stats
+//  returns (
+//   entries integer,
+//   capacity integer,
+//   max_length integer,
+//   hits bigint,
+//   misses bigint
+//  )
+//  external name 'hash!memo_stats'
+//  engine udr;
+//
+// The attachment's memo counters since it was last sized.
+//
+FB_UDR_BEGIN_PROCEDURE(memo_stats)
+
+	DECLARE_RESOURCE
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_INTEGER, entries)
+		(FB_INTEGER, capacity)
+		(FB_INTEGER, max_length)
+		(FB_BIGINT, hits)
+		(FB_BIGINT, misses)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+		attachment_resources* att_resources = nullptr;
+
+		ATTACHMENT_RESORCES
+		const digest_memo& memo = att_resources->memo;
+		out->entriesNull = FB_FALSE;
+		out->entries = static_cast<ISC_LONG>(memo.entries());
+		out->capacityNull = FB_FALSE;
+		out->capacity = static_cast<ISC_LONG>(memo.current_capacity());
+		out->max_lengthNull = FB_FALSE;
+		out->max_length = static_cast<ISC_LONG>(memo.current_max_length());
+		out->hitsNull = FB_FALSE;
+		out->hits = memo.hits;
+		out->missesNull = FB_FALSE;
+		out->misses = memo.misses;
+		fetched = false;
+	}
+
+	bool fetched = true;
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (fetched)
+			return false;
+		fetched = true;
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create procedure row_digests (
+//   hash_ smallint not null,
+//   sql_text varchar(...) character set none (or blob sub_type text)
+//  ) returns (
+//   row_number bigint,
+//   digest varchar(128) character set none
+//  )
+//  external name 'hash!row_digests'
+//  engine udr;
+//
+// Runs sql_text in the caller's attachment and transaction and returns the
+// digest of every row's canonical typed encoding. Rows are read in batches,
+// a batch is hashed on a worker thread while the cursor reads the next one.
+//
+FB_UDR_BEGIN_PROCEDURE(row_digests)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, sql_text
+	};
+
+	static constexpr unsigned BATCH_ROWS = 256;
+
+	struct row_batch // encoded rows in, digests out
+	{
+		std::vector<unsigned char> rows;
+		std::vector<unsigned> offsets; // count + 1
+		std::vector<unsigned char> digests;
+		ISC_INT64 first = 0;
+
+		unsigned count() const { return offsets.empty() ? 0 : static_cast<unsigned>(offsets.size() - 1); }
+	};
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_BIGINT, row_number)
+		(FB_VARCHAR(128), digest)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+
+		ATTACHMENT_RESORCES
+		if (procedure->in_message.null(in, in::sql_text))
+			return;
+		try
+		{
+			const HASH hash =
+				!procedure->in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + procedure->in_message[in::hash].offset))
+					: HASH::Invalid;
+			method = &method_of(hash);
+			if (method->unavailable)
+				throw std::runtime_error(method->unavailable);
+
+			std::string sql;
+			helper.read_value(att_resources, procedure->in_message[in::sql_text], in, &sql);
+
+			try
+			{
+				att.reset(context->getAttachment(status));
+				tra.reset(context->getTransaction(status));
+				stmt.reset(att->prepare(status, tra, static_cast<unsigned>(sql.length()), sql.c_str(),
+					SQL_DIALECT_CURRENT, IStatement::PREPARE_PREFETCH_METADATA));
+				AutoRelease<IMessageMetadata> row_metadata(stmt->getOutputMetadata(status));
+				row.describe(status, row_metadata);
+				buffer.resize(row_metadata->getMessageLength(status));
+				curs.reset(stmt->openCursor(status, tra, NULL, NULL, row_metadata, 0));
+			}
+			catch (...)
+			{
+				throw std::runtime_error("Preparing the row query failed.");
+			}
+
+			hash_ahead(read_rows());
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	attachment_resources* att_resources = nullptr;
+	const method_descriptor* method = nullptr;
+
+	AutoRelease<IAttachment> att;
+	AutoRelease<ITransaction> tra;
+	AutoRelease<IStatement> stmt;
+	AutoRelease<IResultSet> curs;
+	message_description row;
+	std::vector<unsigned char> buffer;
+
+	std::future<row_batch> pending; // being hashed
+	row_batch ready; // being returned
+	unsigned next = 0;
+	ISC_INT64 row_number = 0;
+	bool eof = false;
+
+	row_batch read_rows() // on the fetching thread, it owns the attachment
+	{
+		row_batch batch;
+		batch.first = row_number + 1;
+		batch.offsets.push_back(0);
+		while (!eof && batch.count() < BATCH_ROWS)
+		{
+			FB_UDR_STATUS_TYPE* status = att_resources->current_snapshot()->status;
+			if (curs->fetchNext(status, buffer.data()) != IStatus::RESULT_OK)
+			{
+				eof = true;
+				break;
+			}
+			helper.encode_row(status, att, tra, row, buffer.data(), &batch.rows);
+			batch.offsets.push_back(static_cast<unsigned>(batch.rows.size()));
+			++row_number;
+		}
+		return batch;
+	}
+
+	void hash_ahead(row_batch&& batch)
+	{
+		if (batch.count() > 0)
+			pending = std::async(std::launch::async, hash_rows, method, std::move(batch));
+	}
+
+	static row_batch hash_rows(const method_descriptor* method, row_batch batch) // on a worker thread
+	{
+		std::vector<const unsigned char*> data(batch.count());
+		std::vector<unsigned> lengths(batch.count());
+		for (unsigned i = 0; i < batch.count(); ++i)
+		{
+			data[i] = batch.rows.data() + batch.offsets[i];
+			lengths[i] = batch.offsets[i + 1] - batch.offsets[i];
+		}
+		batch.digests.resize(static_cast<std::size_t>(batch.count()) * method->digest_size);
+		method->batch(data.data(), lengths.data(), batch.count(), batch.digests.data(), method->digest_size);
+		return batch;
+	}
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		attachment_resources* att_resources = this->att_resources;
+		try
+		{
+			if (next >= ready.count())
+			{
+				if (!pending.valid())
+					return false;
+				att_resources->current_snapshot(status, context);
+				row_batch batch = eof ? row_batch() : read_rows(); // overlaps the worker
+				ready = pending.get();
+				next = 0;
+				hash_ahead(std::move(batch));
+			}
+
+			const unsigned size = method->digest_size;
+			out->row_numberNull = FB_FALSE;
+			out->row_number = ready.first + next;
+			out->digestNull = FB_FALSE;
+			encode(ENCODING::Hex, ready.digests.data() + static_cast<std::size_t>(next) * size, size, out->digest.str);
+			out->digest.length = static_cast<ISC_USHORT>(size * 2);
+			++next;
+			return true;
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_SET_ERROR(e.what())
+			return false;
+		}
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create procedure fingerprint (
+//   hash_ smallint not null,
+//   relation varchar(63) character set none not null,
+//   workers integer
+//  ) returns (
+//   range_ integer,
+//   rows_ bigint,
+//   fingerprint varchar(64) character set none,
+//   ms integer
+//  )
+//  external name 'hash!fingerprint'
+//  engine udr;
+//
+// Order independent fingerprint of a table: the sum and the XOR of 128-bit
+// row digests. The data page slots of the pointer pages are split into
+// RDB$DB_KEY ranges, several per worker; every worker reads the ranges it takes
+// on its own attachment in the caller's snapshot (snapshot numbers, Firebird 4)
+// and role. Workers never exceed the cores left free in the thread budget.
+// One row per worker, then the total with range_ NULL.
+//
+FB_UDR_BEGIN_PROCEDURE(fingerprint)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, relation, workers
+	};
+
+	struct row_sum // commutative, ranges merge in any order
+	{
+		ISC_UINT64 sum[2] = { 0, 0 }; // 128-bit big-endian halves
+		ISC_UINT64 mix[2] = { 0, 0 }; // XOR
+		ISC_INT64 rows = 0;
+		ISC_LONG ms = 0;
+		std::string error;
+
+		void add(const unsigned char* digest) // 16 bytes
+		{
+			ISC_UINT64 half[2] = { 0, 0 };
+			for (unsigned i = 0; i < 16; ++i)
+				half[i / 8] = (half[i / 8] << 8) | digest[i];
+			accumulate(half[0], half[1], half[0], half[1]);
+			++rows;
+		}
+
+		void merge(const row_sum& range)
+		{
+			accumulate(range.sum[0], range.sum[1], range.mix[0], range.mix[1]);
+			rows += range.rows;
+		}
+
+		void accumulate(const ISC_UINT64 sum_high, const ISC_UINT64 sum_low, const ISC_UINT64 mix_high, const ISC_UINT64 mix_low)
+		{
+			const ISC_UINT64 low = sum[1] + sum_low;
+			sum[0] += sum_high + (low < sum_low ? 1 : 0);
+			sum[1] = low;
+			mix[0] ^= mix_high;
+			mix[1] ^= mix_low;
+		}
+
+		void fingerprint(char* out) const // 64 hex chars
+		{
+			unsigned char bytes[32];
+			const ISC_UINT64 halves[4] = { sum[0], sum[1], mix[0], mix[1] };
+			for (unsigned i = 0; i < 32; ++i)
+				bytes[i] = static_cast<unsigned char>(halves[i / 8] >> (8 * (7 - i % 8)));
+			encode(ENCODING::Hex, bytes, sizeof(bytes), out);
+		}
+	};
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_INTEGER, range)
+		(FB_BIGINT, rows)
+		(FB_VARCHAR(64), fingerprint)
+		(FB_INTEGER, ms)
+	);
+
+	static constexpr ISC_INT64 RANGES_PER_WORKER = 8; // a worker finishing early takes the next range
+
+	static ISC_INT64 scalar(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& sql)
+	{
+		AutoRelease<IStatement> stmt(att->prepare(status, tra, 0, sql.c_str(), SQL_DIALECT_CURRENT, IStatement::PREPARE_PREFETCH_METADATA));
+		AutoRelease<IMessageMetadata> meta(stmt->getOutputMetadata(status));
+		std::vector<unsigned char> buffer(meta->getMessageLength(status));
+		AutoRelease<IResultSet> curs(stmt->openCursor(status, tra, NULL, NULL, meta, 0));
+
+		ISC_INT64 value = 0;
+		if (curs->fetchNext(status, buffer.data()) == IStatus::RESULT_OK &&
+			*reinterpret_cast<ISC_SHORT*>(buffer.data() + meta->getNullOffset(status, 0)) == 0)
+		{
+			const unsigned char* data = buffer.data() + meta->getOffset(status, 0);
+			value = meta->getType(status, 0) == SQL_LONG ?
+				*reinterpret_cast<const ISC_LONG*>(data) : *reinterpret_cast<const ISC_INT64*>(data);
+		}
+		curs->close(status);
+		curs.release();
+		return value;
+	}
+
+	static void scan(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& sql,
+		const method_descriptor* method, row_sum* range)
+	{
+		const auto started = std::chrono::steady_clock::now();
+
+		AutoRelease<IStatement> stmt(att->prepare(status, tra, 0, sql.c_str(), SQL_DIALECT_CURRENT, IStatement::PREPARE_PREFETCH_METADATA));
+		AutoRelease<IMessageMetadata> meta(stmt->getOutputMetadata(status));
+		message_description row;
+		row.describe(status, meta);
+		std::vector<unsigned char> buffer(meta->getMessageLength(status));
+		AutoRelease<IResultSet> curs(stmt->openCursor(status, tra, NULL, NULL, meta, 0));
+
+		std::vector<unsigned char> encoded;
+		unsigned char digest[64];
+		while (curs->fetchNext(status, buffer.data()) == IStatus::RESULT_OK)
+		{
+			encoded.clear();
+			helper.encode_row(status, att, tra, row, buffer.data(), &encoded);
+			memset(digest, 0, 16); // short digests are zero padded to 128 bits
+			method->digest(encoded.data(), static_cast<unsigned>(encoded.size()), digest, sizeof(digest));
+			range->add(digest);
+		}
+		curs->close(status);
+		curs.release();
+
+		range->ms += static_cast<ISC_LONG>(std::chrono::duration_cast<std::chrono::milliseconds>(
+			std::chrono::steady_clock::now() - started).count());
+	}
+
+	static void scan_attached(IMaster* master, const std::string& database, const std::string& user, const std::string& role,
+		const ISC_INT64 snapshot, const std::vector<std::string>* sql, std::atomic<std::size_t>* next_range,
+		const method_descriptor* method, row_sum* range) // on a worker thread
+	{
+		FB_UDR_STATUS_TYPE status(master->getStatus());
+		try
+		{
+			AutoRelease<IAttachment> att(helper.attach_database(&status, master, database, user, role));
+			const std::string set_transaction = "SET TRANSACTION READ ONLY SNAPSHOT AT NUMBER " + std::to_string(snapshot);
+			AutoRelease<ITransaction> tra(att->execute(&status, NULL, 0, set_transaction.c_str(), SQL_DIALECT_CURRENT,
+				NULL, NULL, NULL, NULL));
+
+			for (std::size_t i; (i = next_range->fetch_add(1)) < sql->size(); )
+				scan(&status, att, tra, (*sql)[i], method, range);
+
+			tra->commit(&status);
+			tra.release();
+			att->detach(&status);
+			att.release();
+		}
+		catch (const FbException& e)
+		{
+			range->error = helper.error_text(master, e);
+		}
+		catch (std::runtime_error const& e)
+		{
+			range->error = e.what();
+		}
+		status.dispose();
+	}
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+		attachment_resources* att_resources = nullptr;
+
+		ATTACHMENT_RESORCES
+		if (procedure->in_message.null(in, in::relation))
+			return;
+		try
+		{
+			const auto started = std::chrono::steady_clock::now();
+			const message_description& in_message = procedure->in_message;
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			const method_descriptor* method = &method_of(hash);
+			if (method->unavailable)
+				throw std::runtime_error(method->unavailable);
+			const ISC_LONG workers =
+				!in_message.null(in, in::workers) ?
+					*reinterpret_cast<ISC_LONG*>(in + in_message[in::workers].offset)
+					: static_cast<ISC_LONG>(std::max(1u, std::thread::hardware_concurrency()));
+			if (workers <= 0)
+				throw std::runtime_error("Worker count must be positive.");
+
+			std::string relation;
+			helper.read_value(att_resources, in_message[in::relation], in, &relation);
+			const std::string literal = helper.quoted(relation, '\'');
+			const std::string select = "SELECT * FROM " + helper.quoted(relation, '"');
+
+			AutoRelease<IAttachment> att(context->getAttachment(status));
+			AutoRelease<ITransaction> tra(context->getTransaction(status));
+
+			ISC_INT64 pointer_pages = 0, page_size = 0, snapshot = 0;
+			try
+			{
+				pointer_pages = scalar(status, att, tra,
+					"SELECT COUNT(*) FROM rdb$pages p JOIN rdb$relations r ON r.rdb$relation_id = p.rdb$relation_id"
+					" WHERE r.rdb$relation_name = " + literal + " AND p.rdb$page_type = 4");
+				page_size = scalar(status, att, tra, "SELECT CAST(mon$page_size AS BIGINT) FROM mon$database");
+			}
+			catch (...)
+			{
+				throw std::runtime_error("Reading pointer pages of the relation failed.");
+			}
+			if (pointer_pages == 0)
+				throw std::runtime_error("Relation not found or has no data pages.");
+			try
+			{
+				snapshot = scalar(status, att, tra, "SELECT CAST(RDB$GET_CONTEXT('SYSTEM', 'SNAPSHOT_NUMBER') AS BIGINT) FROM rdb$database");
+			}
+			catch (...)
+			{
+				snapshot = 0; // before Firebird 4, one range in the caller's transaction
+			}
+
+			// data page slots of a pointer page, at most (page size - header) * 8 / (32 + 8) bits; taken low so
+			// that a slot never runs into the next pointer page and the ranges stay ordered, a full pointer
+			// page's last slots then go with the range reaching into the next one
+			const ISC_INT64 slots = std::max<ISC_INT64>(1, (page_size - 64) / 5);
+			const ISC_INT64 positions = pointer_pages * slots;
+			// workers are attachments and threads: at most the cores, and only those the shared budget has free
+			const ISC_INT64 cores = std::max(1u, std::thread::hardware_concurrency());
+			const thread_budget budget(static_cast<unsigned>(snapshot ? std::min<ISC_INT64>({ workers, positions, cores }) : 1));
+			const ISC_INT64 count = budget.threads();
+			ranges.resize(static_cast<std::size_t>(count));
+			if (count == 1)
+			{
+				try
+				{
+					scan(status, att, tra, select, method, &ranges[0]);
+				}
+				catch (const FbException& e)
+				{
+					throw std::runtime_error(helper.error_text(context->getMaster(), e));
+				}
+			}
+			else
+			{
+				const std::string database(context->getDatabaseName());
+				const std::string user(context->getUserName());
+				std::string role;
+				try
+				{
+					role = helper.current_role(status, att, tra);
+				}
+				catch (const FbException& e)
+				{
+					throw std::runtime_error(helper.error_text(context->getMaster(), e));
+				}
+
+				// (pointer page, slot) ranges, the first and the last open ended
+				const auto dbkey = [&](const ISC_INT64 position)
+				{
+					return "MAKE_DBKEY(" + literal + ", 0, " + std::to_string(position % slots) + ", " +
+						std::to_string(position / slots) + ")";
+				};
+				const ISC_INT64 parts = std::min<ISC_INT64>(count * RANGES_PER_WORKER, positions);
+				std::vector<std::string> sql;
+				sql.reserve(static_cast<std::size_t>(parts));
+				for (ISC_INT64 i = 0; i < parts; ++i)
+				{
+					std::string part = select;
+					if (i > 0)
+						part += " WHERE RDB$DB_KEY >= " + dbkey(positions * i / parts);
+					if (i + 1 < parts)
+						part += (i > 0 ? " AND" : " WHERE") + std::string(" RDB$DB_KEY < ") + dbkey(positions * (i + 1) / parts);
+					sql.push_back(part);
+				}
+
+				std::atomic<std::size_t> next_range{0};
+				std::vector<std::thread> threads;
+				threads.reserve(ranges.size());
+				for (ISC_INT64 i = 0; i < count; ++i)
+					threads.emplace_back(scan_attached, context->getMaster(), database, user, role, snapshot, &sql, &next_range,
+						method, &ranges[static_cast<std::size_t>(i)]);
+				for (auto& thread : threads)
+					thread.join();
+				for (const row_sum& range : ranges)
+					if (!range.error.empty())
+						throw std::runtime_error(range.error);
+			}
+
+			for (const row_sum& range : ranges)
+				total.merge(range);
+			total.ms = static_cast<ISC_LONG>(std::chrono::duration_cast<std::chrono::milliseconds>(
+				std::chrono::steady_clock::now() - started).count());
+		}
+		catch (std::runtime_error const& e)
+		{
+			ranges.clear();
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	std::vector<row_sum> ranges;
+	row_sum total;
+	std::size_t next = 0;
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (next > ranges.size() || ranges.empty())
+			return false;
+
+		const row_sum& range = (next < ranges.size() ? ranges[next] : total);
+		out->rangeNull = (next < ranges.size() ? FB_FALSE : FB_TRUE);
+		out->range = static_cast<ISC_LONG>(next);
+		out->rowsNull = FB_FALSE;
+		out->rows = range.rows;
+		out->fingerprintNull = FB_FALSE;
+		range.fingerprint(out->fingerprint.str);
+		out->fingerprint.length = 64;
+		out->msNull = FB_FALSE;
+		out->ms = range.ms;
+
+		++next;
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create procedure merkle (
+//   hash_ smallint not null,
+//   relation varchar(63) character set none not null,
+//   key_column varchar(63) character set none not null,
+//   fan_out integer not null,
+//   leaf_rows integer not null
+//  ) returns (
+//   level_ integer,
+//   node integer,
+//   low_key bigint,
+//   high_key bigint,
+//   rows_ bigint,
+//   digest varchar(128) character set none
+//  )
+//  external name 'hash!merkle'
+//  engine udr;
+//
+// Every node of the Merkle tree of the relation's rows over its integer key,
+// level 0 are the leaves, the last level is the root.
+//
+
+static std::string merkle_select(const std::string& relation, const std::string& key_column)
+{
+	// the columns as row_digests and row_hash see them, the key is found by name
+	return "SELECT r.* FROM " + helper.quoted(relation, '"') + " r ORDER BY r." + helper.quoted(key_column, '"');
+}
+
+FB_UDR_BEGIN_PROCEDURE(merkle)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, relation, key_column, fan_out, leaf_rows
+	};
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_INTEGER, level)
+		(FB_INTEGER, node)
+		(FB_BIGINT, low_key)
+		(FB_BIGINT, high_key)
+		(FB_BIGINT, rows)
+		(FB_VARCHAR(128), digest)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+		attachment_resources* att_resources = nullptr;
+
 		ATTACHMENT_RESORCES
-		out->keyNull = FB_TRUE;
-		if (!*(reinterpret_cast<ISC_SHORT*>(in + in_null_offsets[in::value])))
+		const message_description& in_message = procedure->in_message;
+		if (in_message.null(in, in::relation) || in_message.null(in, in::key_column))
+			return;
+		try
+		{
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			const ISC_LONG fan_out = *reinterpret_cast<ISC_LONG*>(in + in_message[in::fan_out].offset);
+			const ISC_LONG leaf_rows = *reinterpret_cast<ISC_LONG*>(in + in_message[in::leaf_rows].offset);
+			std::string relation, key_column;
+			helper.read_value(att_resources, in_message[in::relation], in, &relation);
+			helper.read_value(att_resources, in_message[in::key_column], in, &key_column);
+
+			tree.reset(new merkle_tree(&method_of(hash), static_cast<unsigned>(std::max(fan_out, 0)),
+				static_cast<unsigned>(std::max(leaf_rows, 0))));
+			try
+			{
+				AutoRelease<IAttachment> att(context->getAttachment(status));
+				AutoRelease<ITransaction> tra(context->getTransaction(status));
+				tree->build(status, att, tra, merkle_select(relation, key_column), key_column);
+			}
+			catch (const FbException& e)
+			{
+				throw std::runtime_error(helper.error_text(context->getMaster(), e));
+			}
+		}
+		catch (std::runtime_error const& e)
+		{
+			tree.reset();
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	std::unique_ptr<merkle_tree> tree;
+	unsigned level = 0, node = 0;
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (!tree || level >= tree->levels().size())
+			return false;
+
+		const merkle_tree::node& n = tree->levels()[level][node];
+		out->levelNull = FB_FALSE;
+		out->level = static_cast<ISC_LONG>(level);
+		out->nodeNull = FB_FALSE;
+		out->node = static_cast<ISC_LONG>(node);
+		out->low_keyNull = FB_FALSE;
+		out->low_key = n.low;
+		out->high_keyNull = FB_FALSE;
+		out->high_key = n.high;
+		out->rowsNull = FB_FALSE;
+		out->rows = n.rows;
+		out->digestNull = FB_FALSE;
+		encode(ENCODING::Hex, n.digest, tree->digest_size(), out->digest.str);
+		out->digest.length = static_cast<ISC_USHORT>(tree->digest_size() * 2);
+
+		if (++node >= tree->levels()[level].size())
+		{
+			node = 0;
+			++level;
+		}
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create procedure merkle_diff (
+//   hash_ smallint not null,
+//   relation varchar(63) character set none not null,
+//   key_column varchar(63) character set none not null,
+//   fan_out integer not null,
+//   leaf_rows integer not null,
+//   database varchar(255) character set none not null
+//  ) returns (
+//   low_key bigint,
+//   high_key bigint,
+//   local_rows bigint,
+//   remote_rows bigint
+//  )
+//  external name 'hash!merkle_diff'
+//  engine udr;
+//
+// Key ranges low_key <= key < high_key (NULL is unbounded) where the relation
+// differs from the same relation in a second local database, attached embedded
+// as the current user with the current role. The remote tree is built on the local leaf bounds, the
+// comparison descends into mismatching nodes only.
+//
+FB_UDR_BEGIN_PROCEDURE(merkle_diff)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, relation, key_column, fan_out, leaf_rows, database
+	};
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_BIGINT, low_key)
+		(FB_BIGINT, high_key)
+		(FB_BIGINT, local_rows)
+		(FB_BIGINT, remote_rows)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+		attachment_resources* att_resources = nullptr;
+
+		ATTACHMENT_RESORCES
+		const message_description& in_message = procedure->in_message;
+		if (in_message.null(in, in::relation) || in_message.null(in, in::key_column) || in_message.null(in, in::database))
+			return;
+		try
 		{
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			const ISC_LONG fan_out = *reinterpret_cast<ISC_LONG*>(in + in_message[in::fan_out].offset);
+			const ISC_LONG leaf_rows = *reinterpret_cast<ISC_LONG*>(in + in_message[in::leaf_rows].offset);
+			std::string relation, key_column, database;
+			helper.read_value(att_resources, in_message[in::relation], in, &relation);
+			helper.read_value(att_resources, in_message[in::key_column], in, &key_column);
+			helper.read_value(att_resources, in_message[in::database], in, &database);
+			const std::string select = merkle_select(relation, key_column);
+
+			local.reset(new merkle_tree(&method_of(hash), static_cast<unsigned>(std::max(fan_out, 0)),
+				static_cast<unsigned>(std::max(leaf_rows, 0))));
+			merkle_tree remote(*local);
+			std::string role; // the replica checks the same rights as the local side
+			try
+			{
+				AutoRelease<IAttachment> att(context->getAttachment(status));
+				AutoRelease<ITransaction> tra(context->getTransaction(status));
+				local->build(status, att, tra, select, key_column);
+				role = helper.current_role(status, att, tra);
+			}
+			catch (const FbException& e)
+			{
+				throw std::runtime_error(helper.error_text(context->getMaster(), e));
+			}
+
+			IMaster* master = context->getMaster();
+			FB_UDR_STATUS_TYPE remote_status(master->getStatus());
 			try
 			{
-				std::string value;
-				switch (in_types[in::value])
+				AutoRelease<IAttachment> att(helper.attach_database(&remote_status, master, database, context->getUserName(), role));
+				AutoRelease<ITransaction> tra(att->execute(&remote_status, NULL, 0, "SET TRANSACTION READ ONLY SNAPSHOT",
+					SQL_DIALECT_CURRENT, NULL, NULL, NULL, NULL));
+				remote.build_on(&remote_status, att, tra, select, key_column, *local);
+				tra->commit(&remote_status);
+				tra.release();
+				att->detach(&remote_status);
+				att.release();
+			}
+			catch (const FbException& e)
+			{
+				remote_status.dispose();
+				throw std::runtime_error(helper.error_text(master, e));
+			}
+			catch (...)
+			{
+				remote_status.dispose();
+				throw;
+			}
+			remote_status.dispose();
+
+			for (const unsigned leaf : local->differing_leaves(remote))
+				differences.push_back({ leaf, remote.levels().front()[leaf].rows });
+		}
+		catch (std::runtime_error const& e)
+		{
+			differences.clear();
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	std::unique_ptr<merkle_tree> local;
+	std::vector<std::pair<unsigned, ISC_INT64>> differences; // local leaf, remote rows
+	std::size_t next = 0;
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		if (next >= differences.size())
+			return false;
+
+		const std::vector<merkle_tree::node>& leaves = local->levels().front();
+		const unsigned leaf = differences[next].first;
+		out->low_keyNull = (leaf == 0 ? FB_TRUE : FB_FALSE);
+		out->low_key = leaves[leaf].low;
+		out->high_keyNull = (leaf + 1 < leaves.size() ? FB_FALSE : FB_TRUE);
+		out->high_key = (leaf + 1 < leaves.size() ? leaves[leaf + 1].low : 0);
+		out->local_rowsNull = FB_FALSE;
+		out->local_rows = leaves[leaf].rows;
+		out->remote_rowsNull = FB_FALSE;
+		out->remote_rows = differences[next].second;
+
+		++next;
+		return true;
+	}
+
+FB_UDR_END_PROCEDURE
+
+//-----------------------------------------------------------------------------
+// create trigger goods_row_hash for goods
+//  active before insert or update position 0
+//  external name 'hash!row_hash!blake2s!ROW_HASH!NAME,PRICE,PHOTO'
+//  engine udr;
+//
+// Keeps a row digest column current: the listed columns of the new record
+// (all but the target when the list is empty) in the encode_row encoding,
+// BLOBs streamed. The target is [VAR]CHAR, hex or raw when OCTETS.
+//
+FB_UDR_BEGIN_TRIGGER(row_hash)
+
+	DECLARE_RESOURCE
+
+	message_description fields;
+	std::vector<unsigned> columns;
+	unsigned target = 0;
+	std::unique_ptr<keyed_state> state;
+
+	static std::string identifier(const std::string& text) // unquoted ones are upper case
+	{
+		const std::size_t first = text.find_first_not_of(' ');
+		if (first == std::string::npos)
+			return std::string();
+		std::string name = text.substr(first, text.find_last_not_of(' ') - first + 1);
+		if (name.length() >= 2 && name.front() == '"' && name.back() == '"')
+			return name.substr(1, name.length() - 2);
+		std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(toupper(c)); });
+		return name;
+	}
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		try
+		{
+			if (metadata->getTriggerType(status) != IExternalTrigger::TYPE_BEFORE)
+				throw std::runtime_error("row_hash must be a BEFORE INSERT OR UPDATE trigger.");
+
+			AutoRelease<IMessageMetadata> fields_metadata(metadata->getTriggerMetadata(status));
+			fields.describe(status, fields_metadata);
+			std::vector<std::string> names(fields.count());
+			for (unsigned i = 0; i < fields.count(); ++i)
+				names[i] = identifier(fields_metadata->getField(status, i));
+			const auto field_index = [&names](const std::string& name)
+			{
+				const auto found = std::find(names.begin(), names.end(), name);
+				if (found == names.end())
+					throw std::runtime_error("Column in external name is not a field of the table.");
+				return static_cast<unsigned>(found - names.begin());
+			};
+
+			// 'hash!row_hash!method!target!column,column...'
+			const std::string entry_point(metadata->getEntryPoint(status));
+			std::vector<std::string> parts;
+			for (std::size_t begin = 0, end; ; begin = end + 1)
+			{
+				end = entry_point.find('!', begin);
+				parts.push_back(entry_point.substr(begin, end - begin));
+				if (end == std::string::npos)
+					break;
+			}
+			if (parts.size() < 4 || parts.size() > 5)
+				throw std::runtime_error("External name must be 'hash!row_hash!method!target!columns'.");
+
+			const HASH hash = helper.method(parts[2]);
+			if (hash == HASH::Invalid)
+				throw std::runtime_error("Unknown HASH method in external name.");
+			state.reset(helper.digest_state(hash));
+
+			target = field_index(identifier(parts[3]));
+			const field_description& target_field = fields[target];
+			const unsigned digest_length = static_cast<unsigned>(state->finalize_bytes().size());
+			if ((target_field.type != SQL_TEXT && target_field.type != SQL_VARYING) ||
+				target_field.length < (target_field.char_set == 1 /* CS_BINARY */ ? digest_length : digest_length * 2))
+				throw std::runtime_error("Target column must be [VAR]CHAR long enough for the digest.");
+
+			if (parts.size() == 5 && !identifier(parts[4]).empty())
+			{
+				for (std::size_t begin = 0, end; ; begin = end + 1)
 				{
-					case SQL_TEXT: // char
-					case SQL_VARYING: // varchar
-					{
-						if (in_char_sets[in::value] != 0 /* CS_NONE */)
-							throw std::runtime_error("CS_NONE character set is allowed.");
-						ISC_USHORT length =
-							static_cast<ISC_USHORT>(
-								(in_types[in::value] == SQL_TEXT ?
-									in_lengths[in::value] :	//    CHAR(N)    
-									*(reinterpret_cast<ISC_USHORT*>(in + in_offsets[in::value]))
-									)
-								);
-						value.assign(
-							reinterpret_cast<const char*>(in + (in_types[in::value] == SQL_TEXT ? 0 : sizeof(ISC_USHORT)) + in_offsets[in::value]),
-							length
-						);
+					end = parts[4].find(',', begin);
+					const unsigned column = field_index(identifier(parts[4].substr(begin, end - begin)));
+					if (column == target)
+						throw std::runtime_error("Target column can not be hashed.");
+					columns.push_back(column);
+					if (end == std::string::npos)
 						break;
-					}
-					case SQL_BLOB: // blob
+				}
+			}
+			else
+			{
+				for (unsigned i = 0; i < fields.count(); ++i)
+					if (i != target)
+						columns.push_back(i);
+			}
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_EXECUTE_TRIGGER
+	{
+		if (action != IExternalTrigger::ACTION_INSERT && action != IExternalTrigger::ACTION_UPDATE)
+			return;
+
+		ATTACHMENT_RESORCES
+		try
+		{
+			try
+			{
+				AutoRelease<IAttachment> att(context->getAttachment(status));
+				AutoRelease<ITransaction> tra(context->getTransaction(status));
+
+				state->reset();
+				for (const unsigned column : columns)
+					helper.encode_field(status, att, tra, fields, newFields, column,
+						[this](const unsigned char* data, unsigned length) { state->add_data(data, length); });
+			}
+			catch (const FbException& e)
+			{
+				throw std::runtime_error(helper.error_text(context->getMaster(), e));
+			}
+
+			unsigned char digest[64]; // the longest fixed digest
+			const unsigned length = state->finalize_to(digest, sizeof(digest));
+
+			const field_description& field = fields[target];
+			unsigned char* data = newFields + field.offset;
+			const bool raw = (field.char_set == 1 /* CS_BINARY */);
+			const unsigned written = raw ? length : length * 2;
+			unsigned char* text = (field.type == SQL_VARYING ? data + sizeof(ISC_USHORT) : data);
+			if (raw)
+				memcpy(text, digest, length);
+			else
+				encode(ENCODING::Hex, digest, length, reinterpret_cast<char*>(text));
+			if (field.type == SQL_VARYING)
+				*(reinterpret_cast<ISC_USHORT*>(data)) = static_cast<ISC_USHORT>(written);
+			else
+				memset(text + written, raw ? 0 : ' ', field.length - written);
+			fields.set_null(newFields, target, false);
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+FB_UDR_END_TRIGGER
+
+//-----------------------------------------------------------------------------
+// create procedure chunks (
+//   hash_ smallint not null,
+//   min_size integer, -- null is 2048
+//   avg_size integer, -- null is 8192
+//   max_size integer, -- null is 65536
+//   value_ blob sub_type binary
+//  ) returns (
+//   offset_ bigint,
+//   length_ integer,
+//   digest varchar(128) character set none
+//  )
+//  external name 'hash!chunks'
+//  engine udr;
+//
+// Content-defined chunks of value_ (FastCDC: Gear rolling hash, cut points
+// skipped below min_size, normalized masks around avg_size) with the digest of
+// every chunk. The BLOB is read as the rows are fetched: a batch of chunks is
+// hashed on a worker thread while the chunker scans the next one, so memory
+// stays at a few batches whatever the BLOB size.
+//
+
+static constexpr std::array<ISC_UINT64, 256> gear_table() // splitmix64, fixed so chunk boundaries never change
+{
+	std::array<ISC_UINT64, 256> table = {};
+	ISC_UINT64 seed = 0;
+	for (ISC_UINT64& value : table)
+	{
+		ISC_UINT64 z = (seed += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		value = z ^ (z >> 31);
+	}
+	return table;
+}
+
+static constexpr std::array<ISC_UINT64, 256> gear = gear_table();
+
+FB_UDR_BEGIN_PROCEDURE(chunks)
+
+	DECLARE_RESOURCE
+
+	enum in : short {
+		hash = 0, min_size, avg_size, max_size, value
+	};
+
+	static constexpr std::size_t BATCH_BYTES = 1 << 20;
+
+	struct chunk_batch // chunks back to back in, digests out
+	{
+		std::vector<unsigned char> data;
+		std::vector<unsigned> ends;
+		std::vector<unsigned char> digests;
+		ISC_INT64 first = 0; // offset of the first chunk in value_
+
+		unsigned count() const { return static_cast<unsigned>(ends.size()); }
+	};
+
+	message_description in_message;
+
+	FB_UDR_CONSTRUCTOR
+	{
+		INITIALIZE_RESORCES
+
+		AutoRelease<IMessageMetadata> in_metadata(metadata->getInputMetadata(status));
+
+		in_message.describe(status, in_metadata);
+	}
+
+	FB_UDR_DESTRUCTOR
+	{
+		FINALIZE_RESORCES
+	}
+
+	FB_UDR_MESSAGE(
+		OutMessage,
+		(FB_BIGINT, offset)
+		(FB_INTEGER, length)
+		(FB_VARCHAR(128), digest)
+	);
+
+	FB_UDR_EXECUTE_PROCEDURE
+	{
+		const ISC_UINT64 att_id = procedure->att_id;
+
+		ATTACHMENT_RESORCES
+		const message_description& in_message = procedure->in_message;
+		if (in_message.null(in, in::value))
+			return;
+		try
+		{
+			const HASH hash =
+				!in_message.null(in, in::hash) ?
+					static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_message[in::hash].offset))
+					: HASH::Invalid;
+			method = &method_of(hash);
+			if (method->unavailable)
+				throw std::runtime_error(method->unavailable);
+			if (in_message[in::value].sub_type != 0 /* SUB_TYPE BINARY */)
+				throw std::runtime_error("SUB_TYPE BINARY is allowed for BLOB.");
+
+			const auto size = [&](const short field, const ISC_LONG default_size)
+			{
+				return !in_message.null(in, field) ? *reinterpret_cast<ISC_LONG*>(in + in_message[field].offset) : default_size;
+			};
+			min_length = size(in::min_size, 2048);
+			avg_length = size(in::avg_size, 8192);
+			max_length = size(in::max_size, 65536);
+			if (min_length < 64 || min_length >= avg_length || avg_length >= max_length || max_length > (1 << 24))
+				throw std::runtime_error("Chunk sizes must be 64 <= min < avg < max <= 16 MB.");
+
+			// more mask bits below avg_size make cuts rarer, fewer above it more frequent
+			unsigned bits = 0;
+			while ((1L << (bits + 1)) <= avg_length)
+				++bits;
+			mask_small = ~0ULL << (64 - (bits + 1));
+			mask_large = ~0ULL << (64 - (bits - 1));
+
+			try
+			{
+				att.reset(context->getAttachment(status));
+				tra.reset(context->getTransaction(status));
+				blob.reset(att->openBlob(status, tra, reinterpret_cast<ISC_QUAD*>(in + in_message[in::value].offset), 0, NULL));
+			}
+			catch (...)
+			{
+				throw std::runtime_error("Error reading BLOB to stream.");
+			}
+			segment.resize(FB_SEGMENT_SIZE);
+
+			hash_ahead(scan_chunks());
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_THROW(e.what())
+		}
+	}
+
+	attachment_resources* att_resources = nullptr;
+	const method_descriptor* method = nullptr;
+	ISC_LONG min_length = 0, avg_length = 0, max_length = 0;
+	ISC_UINT64 mask_small = 0, mask_large = 0;
+
+	AutoRelease<IAttachment> att;
+	AutoRelease<ITransaction> tra;
+	AutoRelease<IBlob> blob;
+	std::vector<unsigned char> segment;
+	unsigned segment_length = 0, segment_position = 0; // the rest of the segment goes to the next batch
+	bool eof = false;
+
+	ISC_INT64 offset = 0; // of the chunk being scanned
+	unsigned length = 0;
+	ISC_UINT64 fingerprint = 0;
+
+	std::future<chunk_batch> pending; // being hashed
+	chunk_batch ready; // being returned
+	unsigned next = 0;
+
+	chunk_batch scan_chunks() // on the fetching thread, it owns the BLOB; whole chunks, BATCH_BYTES plus one chunk at most
+	{
+		chunk_batch batch;
+		batch.first = offset;
+		const auto cut = [&]()
+		{
+			batch.ends.push_back(static_cast<unsigned>(batch.data.size()));
+			offset += length;
+			length = 0;
+			fingerprint = 0;
+		};
+
+		for (;;)
+		{
+			if (segment_position == segment_length)
+			{
+				if (eof)
+					break;
+				FB_UDR_STATUS_TYPE* status = att_resources->current_snapshot()->status;
+				try
+				{
+					switch (blob->getSegment(status, static_cast<unsigned>(segment.size()), segment.data(), &segment_length))
 					{
-						if (in_sub_types[in::value] != 0 /* SUB_TYPE BINARY */)
-							throw std::runtime_error("SUB_TYPE BINARY is allowed for BLOB.");
-						helper.read_blob(att_resources, reinterpret_cast<ISC_QUAD*>(in + in_offsets[in::value]), &value);
-						break; 
+						case IStatus::RESULT_OK:
+						case IStatus::RESULT_SEGMENT:
+							segment_position = 0;
+							continue;
+						default:
+							eof = true;
+							segment_length = segment_position = 0;
+							blob->close(status);
+							blob.release();
 					}
-					default:
-						throw std::runtime_error("Allowed [VAR]CHAR(N) or BLOB SQL datatype.");
 				}
-				std::string key =
-					helper.hash_key(
-						!*(reinterpret_cast<ISC_SHORT*>(in + in_null_offsets[in::hash])) ?
-							static_cast<HASH>(*reinterpret_cast<ISC_SHORT*>(in + in_offsets[in::hash]))
-							: HASH::Invalid,
-						&value
-					);
-				out->key.length = static_cast<ISC_SHORT>(key.length());
-				memcpy(out->key.str, key.c_str(), out->key.length);
-				out->keyNull = FB_FALSE;
+				catch (...)
+				{
+					throw std::runtime_error("Error reading BLOB to stream.");
+				}
+				if (length > 0) // the tail is the last chunk
+					cut();
+				continue;
 			}
-			catch (std::runtime_error const& e)
+
+			const unsigned char* data = segment.data();
+			const unsigned start = segment_position;
+			unsigned i = segment_position;
+			bool boundary = false;
+			for (; i < segment_length && !boundary; ++i)
 			{
-				HASHUDR_THROW(e.what())
+				++length;
+				if (length > static_cast<unsigned>(min_length))
+				{
+					fingerprint = (fingerprint << 1) + gear[data[i]];
+					boundary = (fingerprint & (length < static_cast<unsigned>(avg_length) ? mask_small : mask_large)) == 0;
+				}
+				boundary = boundary || length >= static_cast<unsigned>(max_length);
 			}
-		} 
+			batch.data.insert(batch.data.end(), data + start, data + i);
+			segment_position = i;
+			if (boundary)
+			{
+				cut();
+				if (batch.data.size() >= BATCH_BYTES)
+					break;
+			}
+		}
+		return batch;
 	}
 
-FB_UDR_END_FUNCTION
+	void hash_ahead(chunk_batch&& batch)
+	{
+		if (batch.count() > 0)
+			pending = std::async(std::launch::async, hash_chunks, method, std::move(batch));
+	}
+
+	static chunk_batch hash_chunks(const method_descriptor* method, chunk_batch batch) // on a worker thread
+	{
+		std::vector<const unsigned char*> data(batch.count());
+		std::vector<unsigned> lengths(batch.count());
+		for (unsigned i = 0; i < batch.count(); ++i)
+		{
+			const unsigned begin = (i == 0 ? 0 : batch.ends[i - 1]);
+			data[i] = batch.data.data() + begin;
+			lengths[i] = batch.ends[i] - begin;
+		}
+		batch.digests.resize(static_cast<std::size_t>(batch.count()) * method->digest_size);
+		method->batch(data.data(), lengths.data(), batch.count(), batch.digests.data(), method->digest_size);
+		return batch;
+	}
+
+	FB_UDR_FETCH_PROCEDURE
+	{
+		attachment_resources* att_resources = this->att_resources;
+		try
+		{
+			if (next >= ready.count())
+			{
+				if (!pending.valid())
+					return false;
+				att_resources->current_snapshot(status, context);
+				chunk_batch batch = scan_chunks(); // overlaps the worker
+				ready = pending.get();
+				next = 0;
+				hash_ahead(std::move(batch));
+			}
+
+			const unsigned begin = (next == 0 ? 0 : ready.ends[next - 1]);
+			const unsigned size = method->digest_size;
+			out->offsetNull = FB_FALSE;
+			out->offset = ready.first + begin;
+			out->lengthNull = FB_FALSE;
+			out->length = static_cast<ISC_LONG>(ready.ends[next] - begin);
+			out->digestNull = FB_FALSE;
+			encode(ENCODING::Hex, ready.digests.data() + static_cast<std::size_t>(next) * size, size, out->digest.str);
+			out->digest.length = static_cast<ISC_USHORT>(size * 2);
+			++next;
+			return true;
+		}
+		catch (std::runtime_error const& e)
+		{
+			HASHUDR_SET_ERROR(e.what())
+			return false;
+		}
+	}
+
+FB_UDR_END_PROCEDURE
 
 } // namespace hashudr
 
@@ -29,7 +29,24 @@
 #include <UdrCppEngine.h>
 
 #include <stdexcept>
-#include <map>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include <blake1_224.h>
 #include <blake1_256.h>
@@ -41,9 +58,14 @@
 #include <cshake.h>
 #include <fnv.h>
 #include <has_160.h>
+#include <hmac.h>
+#include <kdf.h>
+#include <kangaroo_twelve.h>
+#include <kmac.h>
 #include <md2.h>
 #include <md4.h>
 #include <md5.h>
+#include <poly1305.h>
 #include <ripemd_128.h>
 #include <ripemd_160.h>
 #include <ripemd_256.h>
@@ -59,9 +81,13 @@
 #include <sha3.h>
 #include <sm3.h>
 #include <tiger.h>
+#include <tiger_tree.h>
 #include <tuple_hash.h>
+#include <vmac.h>
 #include <whirlpool.h> 
 
+#include "encoding.h"
+
 using namespace Firebird;
 
 #include <string.h>
@@ -80,7 +106,7 @@ namespace hashudr
 //-----------------------------------------------------------------------------
 //
 
-#define	HASHUDR_THROW(exception_message)	\
+#define	HASHUDR_SET_ERROR(exception_message)	\
 {	\
 	if (att_resources == nullptr)	\
 	{	\
@@ -118,6 +144,11 @@ namespace hashudr
 			status->setErrors(vector);	\
 		}	\
 	}	\
+} /* HASHUDR_SET_ERROR */
+
+#define	HASHUDR_THROW(exception_message)	\
+{	\
+	HASHUDR_SET_ERROR(exception_message)	\
 	return; \
 } /* HASHUDR_THROW */	
 
@@ -140,10 +171,9 @@ namespace hashudr
 
 #define	ATTACHMENT_RESORCES	\
 {	\
-	if ((att_resources = pool.current_resources(att_id)) == nullptr)	\
+	if (att_resources == nullptr && (att_resources = pool.current_resources(att_id)) == nullptr)	\
 		HASHUDR_THROW("Attachment resources undefined.")	\
 	att_resources->current_snapshot(status, context);	\
-	att_resources->current_transaction();	\
 } /* ATTACHMENT_RESORCES */
 
 #define	FINALIZE_RESORCES	\
@@ -172,11 +202,63 @@ struct attachment_exception
 	char message[ERROR_MESSAGE_LENGTH];
 };
 
+class exceptions_cache // HASH$ exceptions by database, the catalog is read once per database
+{
+public:
+	const unsigned generation() const { return current_generation.load(std::memory_order_acquire); }
+	bool find(const std::string& database, attachment_exception* exceptions);
+	void store(const std::string& database, const attachment_exception* exceptions, const unsigned generation);
+	void invalidate(const std::string& database); // after ALTER/CREATE EXCEPTION HASH$...
+
+private:
+	using exceptions_array = std::array<attachment_exception, EXCEPTION_ARRAY_SIZE>;
+
+	std::mutex lock;
+	std::unordered_map<std::string, exceptions_array> databases;
+	std::atomic<unsigned> current_generation{0};
+};
+
+extern exceptions_cache exceptions_catalog;
+
+enum class HASH : short;
+
+class digest_memo // recent digests of short unkeyed values by (method, value), least recently used evicted
+{
+public:
+	void configure(const unsigned entries, const unsigned max_length); // 0 entries switches it off
+	bool applies(const unsigned length) const { return length <= max_length && capacity > 0; };
+	bool find(const HASH hash, const unsigned char* data, const unsigned length,
+		unsigned char* digest, unsigned* digest_length); // digest has 64 bytes
+	void store(const HASH hash, const unsigned char* data, const unsigned length,
+		const unsigned char* digest, const unsigned digest_length);
+
+	unsigned entries() const { return static_cast<unsigned>(order.size()); };
+	unsigned current_capacity() const { return capacity; };
+	unsigned current_max_length() const { return max_length; };
+	ISC_INT64 hits = 0;
+	ISC_INT64 misses = 0;
+
+private:
+	struct entry
+	{
+		std::string key; // method then value
+		unsigned char digest[64];
+		unsigned length;
+	};
+
+	std::list<entry> order; // most recent first
+	std::unordered_map<std::string_view, std::list<entry>::iterator> index; // views of the keys in order
+	unsigned capacity = 0;
+	unsigned max_length = 0;
+	std::string probe; // lookup key, its buffer is reused
+
+	const std::string& key_of(const HASH hash, const unsigned char* data, const unsigned length);
+};
+
 struct attachment_snapshot
 {
 	FB_UDR_STATUS_TYPE* status;
 	FB_UDR_CONTEXT_TYPE* context;
-	ITransaction* transaction;
 };
 
 class attachment_resources
@@ -187,11 +269,13 @@ public:
 
 	const ISC_UINT64 current_attachment_id() {	return attachment_id; };
 	const attachment_snapshot* current_snapshot(FB_UDR_STATUS_TYPE* status = nullptr, FB_UDR_CONTEXT_TYPE* context = nullptr);
-	const ITransaction* current_transaction(ITransaction* transaction = nullptr);
+	ITransaction* current_transaction(); // new reference, only BLOBs need it
 
 	const ISC_LONG exception_number(const char* name);
 	const char* exception_message(const char* name);
 
+	digest_memo memo; // statements of an attachment do not run concurrently
+
 private:
 	friend class resorces_pool;
 
@@ -201,7 +285,12 @@ private:
 		{HASHUDR_ERROR,		0, ""}
 	};
 	attachment_snapshot snapshot;
+	std::atomic<unsigned> references{1}; // routine instances of the attachment, see resorces_pool
+
+	bool exceptions_pulled = false; // lazily, on the first error raised
+	unsigned exceptions_generation = 0;
 
+	bool current_exceptions();
 	void pull_up_exceptions();
 };
 
@@ -209,7 +298,7 @@ private:
 //     UDR .
 //
 
-using resorces_mapping = std::map<ISC_UINT64, attachment_resources*>;
+using resorces_mapping = std::unordered_map<ISC_UINT64, attachment_resources*>;
 
 class resorces_pool
 {
@@ -222,9 +311,16 @@ public:
 	void finalize_attachment(const ISC_UINT64 attachment_id);
 
 private:
-	resorces_mapping resources_map;
-	resorces_mapping::iterator resources_it;
+	static constexpr unsigned SHARDS = 64; // attachments are spread by id, a shard is locked alone
 
+	struct alignas(64) shard
+	{
+		std::shared_mutex lock; // shared for lookups, exclusive for attach/detach
+		resorces_mapping resources_map;
+	};
+	shard shards[SHARDS];
+
+	shard& shard_of(const ISC_UINT64 attachment_id) { return shards[attachment_id % SHARDS]; }
 	ISC_UINT64 attachment_id(FB_UDR_STATUS_TYPE* status, FB_UDR_CONTEXT_TYPE* context);
 };
 
@@ -240,7 +336,7 @@ enum class HASH : short
 	Blake1_224, Blake1_256, Blake1_384, Blake1_512,
 	Blake2, Blake2s,
 	Crc_32,
-	Cshake_128, Cshake_256, /* will in future */
+	Cshake_128, Cshake_256,
 	Fnv32_1a, Fnv64_1a,
 	Has160,
 	Md2, Md4, Md5,
@@ -250,19 +346,306 @@ enum class HASH : short
 	Sha2_224, Sha2_256, Sha2_384, Sha2_512,
 	Sha2_512_224, Sha2_512_256,
 	Sha3_224, Sha3_256, Sha3_384, Sha3_512,
-	Shake_128, Shake_256, /* will in future */
+	Shake_128, Shake_256,
 	Sm3,
 	Tiger1_128, Tiger1_160, Tiger1_192,
 	Tiger2_128, Tiger2_160, Tiger2_192,
-	Tuple_hash_128, Tuple_hash_256, /* will in future */
-	Whirlpool
+	Tuple_hash_128, Tuple_hash_256,
+	Whirlpool,
+	Kangaroo_twelve,
+	Turboshake_128, Turboshake_256,
+	Kmac_128, Kmac_256,
+	Kmacxof_128, Kmacxof_256,
+	Tiger_tree,
+	Poly1305, Vmac
+};
+
+//-----------------------------------------------------------------------------
+// Message layout of a routine, cached once in the constructor.
+//
+
+struct field_description
+{
+	unsigned type;
+	unsigned sub_type;
+	int scale;
+	unsigned length;
+	unsigned char_set;
+	unsigned offset;
+	unsigned null_offset;
+};
+
+class message_description
+{
+public:
+	void describe(FB_UDR_STATUS_TYPE* status, IMessageMetadata* metadata);
+
+	unsigned count() const { return static_cast<unsigned>(fields.size()); };
+	const field_description& operator[](const unsigned index) const { return fields[index]; };
+
+	bool null(const unsigned char* message, const unsigned index) const
+	{
+		return *(reinterpret_cast<const ISC_SHORT*>(message + fields[index].null_offset)) != 0;
+	};
+	void set_null(unsigned char* message, const unsigned index, const bool null) const
+	{
+		*(reinterpret_cast<ISC_SHORT*>(message + fields[index].null_offset)) = (null ? FB_TRUE : FB_FALSE);
+	};
+
+private:
+	std::vector<field_description> fields;
+};
+
+//-----------------------------------------------------------------------------
+// Keyed hash state. The key is absorbed once, every call restarts from
+// the keyed midstate and absorbs the message only.
+//
+
+class keyed_state
+{
+public:
+	virtual ~keyed_state() {};
+
+	virtual void reset() = 0;
+	virtual void nonce(const std::string* nonce) // NULL nonce is nullptr, called after reset()
+	{
+		if (nonce)
+			throw std::runtime_error("HASH method does not take nonce.");
+	};
+	virtual void add_data(const unsigned char* data, const unsigned length) = 0;
+	virtual std::string finalize() = 0;
+	virtual std::vector<unsigned char> finalize_bytes() = 0;
+	virtual unsigned finalize_to(unsigned char* out, const unsigned capacity) // copies up to capacity, returns the digest length
+	{
+		const std::vector<unsigned char> digest = finalize_bytes();
+		memcpy(out, digest.data(), std::min<std::size_t>(digest.size(), capacity));
+		return static_cast<unsigned>(digest.size());
+	};
+};
+
+template <typename T>
+class keyed_state_of : public keyed_state
+{
+public:
+	explicit keyed_state_of(T&& hash) : hash(std::move(hash)) {};
+
+	void reset() override { hash.reset(); };
+	void add_data(const unsigned char* data, const unsigned length) override { hash.addData(data, length); };
+	std::string finalize() override { return hash.finalize().toString(); };
+	std::vector<unsigned char> finalize_bytes() override { return hash.finalize().toVector(); };
+
+protected:
+	T hash;
+};
+
+template <typename T>
+class nonced_state : public keyed_state_of<T> // the per-key precomputation is kept, only the nonce changes per call
+{
+public:
+	explicit nonced_state(T&& hash) : keyed_state_of<T>(std::move(hash)) {};
+
+	void nonce(const std::string* nonce) override
+	{
+		if (!nonce)
+			throw std::runtime_error("HASH method requires nonce.");
+		this->hash.setNonce(*nonce);
+	};
+};
+
+template <typename T, typename = void>
+struct has_to_array : std::false_type {};
+
+template <typename T>
+struct has_to_array<T, std::void_t<decltype(std::declval<const T&>().toArray())>> : std::true_type {};
+
+template <typename T, typename = void>
+struct has_to_span : std::false_type {};
+
+template <typename T>
+struct has_to_span<T, std::void_t<decltype(std::declval<const T&>().toSpan())>> : std::true_type {};
+
+template <typename T>
+unsigned finalize_hash(T& hash, unsigned char* out, const unsigned capacity) // copies up to capacity, returns the digest length
+{
+	hash.finalize();
+	if constexpr (has_to_array<T>::value || has_to_span<T>::value) // no heap, toArray() or the sponge's toSpan()
+	{
+		const auto digest = [&hash]()
+		{
+			if constexpr (has_to_array<T>::value)
+				return hash.toArray();
+			else
+				return hash.toSpan();
+		}();
+		memcpy(out, digest.data(), std::min<std::size_t>(digest.size(), capacity));
+		return static_cast<unsigned>(digest.size());
+	}
+	else
+	{
+		const std::vector<unsigned char> digest = hash.toVector();
+		memcpy(out, digest.data(), std::min<std::size_t>(digest.size(), capacity));
+		return static_cast<unsigned>(digest.size());
+	}
+}
+
+template <typename T>
+class prefixed_state : public keyed_state // the midstate after prefix is copied back instead of recompressing the prefix
+{
+public:
+	prefixed_state(T&& hash, const std::string& prefix) : prefixed(std::move(hash))
+	{
+		prefixed.addData(prefix.data(), prefix.length());
+		reset();
+	};
+
+	void reset() override { hash = prefixed; };
+	void add_data(const unsigned char* data, const unsigned length) override { hash.addData(data, length); };
+	std::string finalize() override { return hash.finalize().toString(); };
+	std::vector<unsigned char> finalize_bytes() override { return hash.finalize().toVector(); };
+	unsigned finalize_to(unsigned char* out, const unsigned capacity) override { return finalize_hash(hash, out, capacity); };
+
+private:
+	T prefixed;
+	T hash = prefixed;
+};
+
+class keyed_cache // one per routine instance, rebuilt only when the key arguments change
+{
+public:
+	keyed_state* acquire(const std::string& signature, const std::function<keyed_state*()>& build);
+
+private:
+	std::string signature;
+	std::unique_ptr<keyed_state> state;
+};
+
+//-----------------------------------------------------------------------------
+// Method registry. One descriptor per HASH value, in enum order: routines
+// look up states, sizes and capabilities here instead of switching on HASH.
+//
+
+enum method_kernel : unsigned
+{
+	KERNEL_PORTABLE = 0x01,	// C++ only
+	KERNEL_THREADS = 0x02	// large values are hashed on worker threads
+};
+
+struct method_descriptor
+{
+	HASH hash;
+	const char* name;		// selector name, lower case
+	unsigned digest_size;	// bytes, 0 when the caller gives the length
+	unsigned block_size;	// bytes absorbed per compression
+	unsigned kernels;		// method_kernel flags
+	const char* unavailable; // why the method has no plain digest, nullptr when it has
+
+	keyed_state* (*state)(const std::string& prefix); // streaming
+	unsigned (*digest)(const unsigned char* data, const unsigned length, unsigned char* out, const unsigned capacity); // one-shot
+	void (*batch)(const unsigned char* const* data, const unsigned* lengths, const unsigned count,
+		unsigned char* out, const unsigned stride); // count digests, stride bytes apart, hashed serially
+
+	keyed_state* (*hmac_state)(const std::string& key); // nullptr when the method has no HMAC
+	std::vector<unsigned char> (*pbkdf2)(const std::string& password, const std::string& salt,
+		const unsigned iterations, const unsigned length);
+	std::vector<unsigned char> (*hkdf)(const std::string& ikm, const std::string& salt,
+		const std::string& info, const unsigned length);
+};
+
+const method_descriptor& method_of(const HASH hash); // the Invalid descriptor for unknown values
+const method_descriptor* methods_begin();
+const method_descriptor* methods_end();
+
+//-----------------------------------------------------------------------------
+// Merkle tree of row digests over primary key ranges. The query is ordered by
+// the integer key column named key_column, rows are hashed in the row_digests
+// encoding; a leaf holds leaf_rows rows, a node hashes up to fan_out children.
+//
+
+class merkle_tree
+{
+public:
+	struct node
+	{
+		ISC_INT64 low, high; // keys of the first and the last row
+		ISC_INT64 rows;
+		unsigned char digest[64];
+	};
+
+	merkle_tree(const method_descriptor* method, const unsigned fan_out, const unsigned leaf_rows);
+
+	void build(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+		const std::string& key_column);
+	void build_on(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+		const std::string& key_column, const merkle_tree& bounds); // leaf i takes keys from bounds' leaf i low up to leaf i + 1 low
+	std::vector<unsigned> differing_leaves(const merkle_tree& other) const; // descends into mismatching nodes only
+
+	const std::vector<std::vector<node>>& levels() const { return tree; };
+	unsigned digest_size() const { return method->digest_size; };
+
+private:
+	const method_descriptor* method;
+	const unsigned fan_out;
+	const unsigned leaf_rows;
+	std::vector<std::vector<node>> tree; // [0] are the leaves, back() is the root
+
+	void scan(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, const std::string& select,
+		const std::string& key_column, const std::function<void(const ISC_INT64, const std::vector<unsigned char>&)>& consume);
+	void build_levels();
 };
 
 class hash_helper
 {
 public:
 	void read_blob(attachment_resources* att_resources, ISC_QUAD* in, std::string* out);
-	std::string hash_key(const HASH hash, const std::string* value);
+	void stream_blob(attachment_resources* att_resources, ISC_QUAD* in,
+		const std::function<void(ISC_INT64)>& begin, const std::function<void(const unsigned char*, unsigned)>& consume);
+	void stream_blob(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra, ISC_QUAD* in,
+		const std::function<void(ISC_INT64)>& begin, const std::function<void(const unsigned char*, unsigned)>& consume);
+	void write_blob(attachment_resources* att_resources, ISC_QUAD* out, const ISC_INT64 length,
+		const std::function<void(unsigned char*, unsigned)>& fill);
+
+	void read_value(attachment_resources* att_resources, const field_description& field, const unsigned char* message, std::string* out);
+	void write_string(const field_description& field, unsigned char* message, const std::string& value);
+	void write_bytes(attachment_resources* att_resources, const field_description& field, unsigned char* message,
+		const std::vector<unsigned char>& value);
+	void write_octets(const field_description& field, unsigned char* message, const unsigned char* value, const unsigned length);
+	void write_integer(const field_description& field, unsigned char* message, const unsigned char* digest, const unsigned length);
+	unsigned bytes_capacity(const field_description& field);
+
+
+	std::string xof_key(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+		const field_description& field, const unsigned char* message); // the value is streamed, a BLOB is never buffered
+	void xof_blob(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+		const field_description& field, const unsigned char* message, ISC_QUAD* out);
+	std::string tuple_key(attachment_resources* att_resources, const HASH hash, const ISC_LONG digest, const std::string* custom,
+		const message_description& in_message, const unsigned char* in, const unsigned first);
+	IAttachment* attach_database(FB_UDR_STATUS_TYPE* status, IMaster* master, const std::string& database, const std::string& user,
+		const std::string& role = std::string()); // role as given by CURRENT_ROLE, empty or NONE is none
+	std::string current_role(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra); // CURRENT_ROLE of the caller
+	std::string error_text(IMaster* master, const FbException& e);
+	std::string quoted(const std::string& text, const char quote); // SQL literal ' or identifier "
+	void encode_field(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra,
+		const message_description& row, const unsigned char* message, const unsigned index,
+		const std::function<void(const unsigned char*, unsigned)>& consume); // canonical typed encoding, BLOBs streamed
+	void encode_row(FB_UDR_STATUS_TYPE* status, IAttachment* att, ITransaction* tra,
+		const message_description& row, const unsigned char* message, std::vector<unsigned char>* out); // every field, appended to out
+
+	void feed_value(attachment_resources* att_resources, const field_description& field, const unsigned char* message,
+		const std::function<void(const unsigned char*, unsigned)>& consume,
+		const std::function<void(ISC_INT64)>& begin = nullptr); // begin, when given, gets the total length first
+	keyed_state* kmac_state(const HASH hash, const ISC_LONG digest, const std::string* key, const std::string* custom);
+	keyed_state* hmac_state(const HASH hash, const std::string* key);
+	keyed_state* prefix_state(const HASH hash, const std::string* prefix);
+	keyed_state* digest_state(const HASH hash);
+	keyed_state* mac_state(const HASH hash, const std::string* key);
+
+	HASH method(const std::string& name); // by its selector name, case insensitive
+	HASH entry_method(FB_UDR_STATUS_TYPE* status, IRoutineMetadata* metadata); // 'hash!routine!method', or Invalid
+
+	std::vector<unsigned char> pbkdf2(const HASH hash, const std::string* password, const std::string* salt,
+		const ISC_LONG iterations, const ISC_LONG length);
+	std::vector<unsigned char> hkdf(const HASH hash, const std::string* ikm, const std::string* salt,
+		const std::string* info, const ISC_LONG length);
 };
 
 extern hash_helper helper;